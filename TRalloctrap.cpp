@@ -0,0 +1,14 @@
+//
+//  TRalloctrap.cpp
+//  TRextern
+//
+//  Copyright © 2026 Reactify. All rights reserved.
+//
+
+// Replacement operator new/delete for TREXTERN_ALLOC_TRAP builds. Link
+// this file once into every binary built with the trap, including
+// libraries made of several classes. It is empty otherwise.
+
+#include "TRarena.h"
+
+TREXTERN_ALLOCATION_TRAP()
@@ -0,0 +1,222 @@
+//
+//  TRarena.h
+//  TRextern
+//
+//  Copyright © 2026 Reactify. All rights reserved.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <cstdio>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+//! Size used to align per-object DSP data
+#ifndef TREXTERN_CACHE_LINE
+#define TREXTERN_CACHE_LINE 64
+#endif
+
+//! Cache line aligned allocation, freed with tr_alignedfree()
+inline void *tr_alignedalloc( size_t bytes ) {
+#ifdef _WIN32
+  return _aligned_malloc( bytes, TREXTERN_CACHE_LINE );
+#else
+  void *p = nullptr;
+  if ( posix_memalign( &p, TREXTERN_CACHE_LINE, bytes ) ) return nullptr;
+  return p;
+#endif
+}
+
+inline void tr_alignedfree( void *p ) {
+#ifdef _WIN32
+  _aligned_free( p );
+#else
+  free( p );
+#endif
+}
+
+//! How an arena buffer's size follows the DSP settings
+enum class ArenaScale {
+  Fixed,     //!< amount elements
+  PerBlock,  //!< amount elements per sample of the block
+  PerSecond  //!< amount elements per second, e.g. amount = 2 for a two second delay line
+};
+
+//! Single cache aligned block of memory holding all DSP buffers of an
+//  object. Buffers are reserved during setup and laid out by prepare(),
+//  which only reallocates when the sample rate or block size changes.
+//  Buffers are zeroed when they are (re)allocated.
+class Arena {
+public:
+  Arena() : mMemory(nullptr), mBytes(0), mSampleRate(0), mBlockSize(0), mDirty(true) {}
+  ~Arena() { release(); }
+  Arena( const Arena& ) = delete;
+  Arena& operator=( const Arena& ) = delete;
+
+  //! Adds a buffer and returns its slot
+  size_t reserve( size_t elementSize, size_t alignment, double amount, ArenaScale scale ) {
+    mSlots.push_back( { elementSize, alignment, amount, scale, nullptr, 0 } );
+    mDirty = true;
+    return mSlots.size() - 1;
+  }
+
+  //! Lays out every buffer for the given DSP settings. Returns false if
+  //  memory couldn't be allocated, leaving all buffers empty
+  bool prepare( double sampleRate, long blockSize ) {
+    if ( !mDirty && mMemory && sampleRate == mSampleRate && blockSize == mBlockSize ) return true;
+    release();
+    mSampleRate = sampleRate;
+    mBlockSize  = blockSize;
+    mDirty      = false;
+
+    size_t total = 0;
+    for ( auto& s : mSlots ) {
+      s.count = elements( s );
+      total   = align( total, s.alignment ) + s.count * s.elementSize;
+    }
+    if ( total == 0 ) return true;
+    total = align( total, TREXTERN_CACHE_LINE );
+    mMemory = tr_alignedalloc( total );
+    if ( !mMemory ) {
+      for ( auto& s : mSlots ) s.count = 0;
+      return false;
+    }
+    std::memset( mMemory, 0, total );
+    mBytes = total;
+
+    size_t offset = 0;
+    for ( auto& s : mSlots ) {
+      offset = align( offset, s.alignment );
+      s.data = static_cast<char *>( mMemory ) + offset;
+      offset += s.count * s.elementSize;
+    }
+    return true;
+  }
+
+  //! Frees the memory. Buffers are empty until the next prepare()
+  void release() {
+    tr_alignedfree( mMemory );
+    mMemory = nullptr;
+    mBytes  = 0;
+    mDirty  = true;
+    for ( auto& s : mSlots ) {
+      s.data  = nullptr;
+      s.count = 0;
+    }
+  }
+
+  void*  data ( size_t slot ) const { return mSlots[slot].data; }
+  size_t count( size_t slot ) const { return mSlots[slot].count; }
+  size_t bytes() const { return mBytes; }
+
+private:
+  struct Slot {
+    size_t     elementSize;
+    size_t     alignment;
+    double     amount;
+    ArenaScale scale;
+    void*      data;
+    size_t     count;
+  };
+
+  size_t elements( const Slot& s ) const {
+    switch ( s.scale ) {
+      case ArenaScale::PerBlock:  return (size_t)std::ceil( s.amount * mBlockSize );
+      case ArenaScale::PerSecond: return (size_t)std::ceil( s.amount * mSampleRate );
+      default:                    return (size_t)std::ceil( s.amount );
+    }
+  }
+
+  static size_t align( size_t offset, size_t alignment ) {
+    if ( alignment < TREXTERN_CACHE_LINE ) alignment = TREXTERN_CACHE_LINE;
+    return (offset + alignment - 1) / alignment * alignment;
+  }
+
+  std::vector<Slot> mSlots;
+  void*   mMemory;
+  size_t  mBytes;
+  double  mSampleRate;
+  long    mBlockSize;
+  bool    mDirty;
+};
+
+//! Handle to a buffer in an object's arena. Cheap to copy; data() is only
+//  valid while DSP is prepared and may move when the DSP settings change
+template<class T>
+class ArenaBuffer {
+  static_assert( std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value,
+                 "Arena buffers hold plain data only" );
+public:
+  ArenaBuffer() : mArena(nullptr), mSlot(0) {}
+  ArenaBuffer( const Arena *arena, size_t slot ) : mArena(arena), mSlot(slot) {}
+
+  T*     data()  const { return mArena ? static_cast<T *>( mArena->data( mSlot ) ) : nullptr; }
+  size_t size()  const { return mArena ? mArena->count( mSlot ) : 0; }
+  bool   empty() const { return size() == 0; }
+
+  T&     operator[]( size_t i ) const { return data()[i]; }
+  T*     begin() const { return data(); }
+  T*     end()   const { return data() + size(); }
+
+private:
+  const Arena *mArena;
+  size_t       mSlot;
+};
+
+//! Allocation trap. With TREXTERN_ALLOC_TRAP defined, any operator new on
+//  a thread inside process() prints a message and aborts. For debug builds.
+//  The binary must also contain one expansion of TREXTERN_ALLOCATION_TRAP()
+inline bool& tr_allocationtrapped() {
+  static thread_local bool trapped = false;
+  return trapped;
+}
+
+//! Arms the trap for the current thread while in scope
+class AllocationTrap {
+public:
+  AllocationTrap() : mPrevious( tr_allocationtrapped() ) { tr_allocationtrapped() = true; }
+  ~AllocationTrap() { tr_allocationtrapped() = mPrevious; }
+  AllocationTrap( const AllocationTrap& ) = delete;
+  AllocationTrap& operator=( const AllocationTrap& ) = delete;
+private:
+  bool mPrevious;
+};
+
+#ifdef TREXTERN_ALLOC_TRAP
+//! Checked allocation used by the replacement allocation functions.
+//  Over-aligned (C++17) allocations are not checked
+inline void *tr_trappednew( size_t size ) {
+  if ( tr_allocationtrapped() ) {
+    tr_allocationtrapped() = false;
+    fprintf( stderr, "TRextern: heap allocation of %zu bytes inside process()\n", size );
+    std::abort();
+  }
+  if ( void *p = std::malloc( size ? size : 1 ) ) return p;
+  throw std::bad_alloc();
+}
+
+//! Defines the replacement global allocation functions. They can't be
+//  inline, so this must be expanded in exactly one source file of the
+//  binary. TRalloctrap.cpp does so and the generated Makefile links it
+//  into Debug builds
+#define TREXTERN_ALLOCATION_TRAP() \
+void *operator new  ( size_t size ) { return tr_trappednew( size ); } \
+void *operator new[]( size_t size ) { return tr_trappednew( size ); } \
+void *operator new  ( size_t size, const std::nothrow_t& ) noexcept { \
+  try { return tr_trappednew( size ); } catch ( ... ) { return nullptr; } \
+} \
+void *operator new[]( size_t size, const std::nothrow_t& ) noexcept { \
+  try { return tr_trappednew( size ); } catch ( ... ) { return nullptr; } \
+} \
+void operator delete  ( void *p ) noexcept { std::free( p ); } \
+void operator delete[]( void *p ) noexcept { std::free( p ); } \
+void operator delete  ( void *p, size_t ) noexcept { std::free( p ); } \
+void operator delete[]( void *p, size_t ) noexcept { std::free( p ); }
+#else
+#define TREXTERN_ALLOCATION_TRAP()
+#endif
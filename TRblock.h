@@ -0,0 +1,123 @@
+//
+//  TRblock.h
+//  TRextern
+//
+//  Copyright © 2026 Reactify. All rights reserved.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+//! Turns the host's blocks into frames of a fixed size. Inputs collect in
+//  a frame until it is full, the frame is processed, and its outputs go
+//  into a queue that the host's blocks are read from, delayed by latency()
+//  samples. The delay is the least that never runs dry with blocks of the
+//  prepared size: frameSize - gcd( frameSize, blockSize ), so none when
+//  frames divide the block, in which case they are processed in place
+template<class T>
+class BlockFifo {
+public:
+  BlockFifo() : mIns(0), mOuts(0), mFrame(0), mLatency(0), mCapacity(0),
+                mFill(0), mRead(0), mWrite(0), mFrameStart(0) {}
+
+  //! Main thread. Allocates and zeroes the buffers
+  void prepare( int ins, int outs, long frameSize, long blockSize ) {
+    mIns      = ins;
+    mOuts     = outs;
+    mFrame    = frameSize;
+    mLatency  = frameSize - std::gcd( frameSize, blockSize );
+    // Holds the latency plus at most one block ahead of the reader
+    mCapacity = frameSize + blockSize;
+    auto const channels = size_t(ins + outs);
+    mSamples.assign( channels * frameSize + outs * mCapacity, T(0) );
+    mChannels.resize( 2 * channels );
+    auto p = mSamples.data();
+    for ( int c = 0; c < ins + outs; c++, p += frameSize ) mChannels[c] = p;
+    mQueue.resize( outs );
+    for ( int c = 0; c < outs; c++, p += mCapacity ) mQueue[c] = p;
+    mFill  = 0;
+    mRead  = 0;
+    mWrite = mLatency;
+  }
+
+  long frameSize() const { return mFrame; }
+  long latency()   const { return mLatency; }
+  //! Audio thread. While a frame is processed, where its first sample was
+  //  in the block being fed. Negative if the frame began in earlier blocks
+  long frameStart() const { return mFrameStart; }
+
+  //! Audio thread. Feeds one block through, calling
+  //  process( ins, outs, frameSize ) for every frame it completes
+  template<class Process>
+  void process( T *const *ins, T *const *outs, long size, Process&& process ) {
+    auto const direct = mChannels.data() + mIns + mOuts;
+    long done = 0;
+    while ( done < size ) {
+      // Whole frames with nothing queued run on the host's buffers
+      if ( mLatency == 0 && mFill == 0 && mRead == mWrite && size - done >= mFrame ) {
+        for ( int c = 0; c < mIns; c++ )  direct[c] = ins[c] + done;
+        for ( int c = 0; c < mOuts; c++ ) direct[mIns + c] = outs[c] + done;
+        mFrameStart = done;
+        process( direct, direct + mIns, mFrame );
+        done += mFrame;
+        continue;
+      }
+      auto const count = std::min( mFrame - mFill, size - done );
+      for ( int c = 0; c < mIns; c++ ) {
+        std::copy( ins[c] + done, ins[c] + done + count, mChannels[c] + mFill );
+      }
+      mFill += count;
+      if ( mFill == mFrame ) {
+        mFrameStart = done + count - mFrame;
+        process( mChannels.data(), mChannels.data() + mIns, mFrame );
+        push( mChannels.data() + mIns );
+        mFill = 0;
+      }
+      pull( outs, done, count );
+      done += count;
+    }
+  }
+
+private:
+  void push( T *const *frame ) {
+    auto const first = std::min( mFrame, mCapacity - mWrite );
+    for ( int c = 0; c < mOuts; c++ ) {
+      std::copy( frame[c], frame[c] + first, mQueue[c] + mWrite );
+      std::copy( frame[c] + first, frame[c] + mFrame, mQueue[c] );
+    }
+    mWrite = (mWrite + mFrame) % mCapacity;
+  }
+
+  //! Samples the queue doesn't have yet, with blocks larger than
+  //  prepared for, are zeroed
+  void pull( T *const *outs, long offset, long count ) {
+    auto const queued = (mWrite - mRead + mCapacity) % mCapacity;
+    auto const ready  = std::min( count, queued );
+    auto const first  = std::min( ready, mCapacity - mRead );
+    for ( int c = 0; c < mOuts; c++ ) {
+      auto out = outs[c] + offset;
+      std::copy( mQueue[c] + mRead, mQueue[c] + mRead + first, out );
+      std::copy( mQueue[c], mQueue[c] + (ready - first), out + first );
+      std::fill( out + ready, out + count, T(0) );
+    }
+    mRead = (mRead + ready) % mCapacity;
+  }
+
+  int              mIns;
+  int              mOuts;
+  long             mFrame;
+  long             mLatency;
+  long             mCapacity;
+  //! Samples of the current frame's inputs collected so far
+  long             mFill;
+  long             mRead;
+  long             mWrite;
+  long             mFrameStart;
+  std::vector<T>   mSamples;
+  //! Frame inputs and outputs, then pointers into the host's buffers
+  std::vector<T*>  mChannels;
+  std::vector<T*>  mQueue;
+};
@@ -0,0 +1,386 @@
+//
+//  TRbuffer.h
+//  TRextern
+//
+//  Copyright © 2026 Reactify. All rights reserved.
+//
+
+#pragma once
+
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//! Read-only view of a loaded sound file or table, safe to use in
+//  process() while the buffer it came from is held. Samples are
+//  interleaved floats
+struct SampleView {
+  const float* data       = nullptr;
+  size_t       frames     = 0;
+  int          channels   = 0;
+  double       sampleRate = 0;
+
+  bool         empty() const { return frames == 0; }
+  const float* frame( size_t index ) const { return data + index * channels; }
+  float        sample( size_t index, int channel ) const { return data[index * channels + channel]; }
+};
+
+//! Samples of one file, shared by every object that loaded it. Files
+//  holding 32 bit floats are used straight from the file mapping, so pages
+//  are only read in when played and are shared with the OS file cache.
+//  Other formats are decoded once into page aligned memory
+class SampleBuffer {
+  friend class BufferCache;
+public:
+  ~SampleBuffer() { release(); }
+  SampleBuffer( const SampleBuffer& ) = delete;
+  SampleBuffer& operator=( const SampleBuffer& ) = delete;
+
+  SampleView         view()     const { return mView; }
+  std::string const& path()     const { return mPath; }
+  //! True if the samples are read from the file mapping without decoding
+  bool               isMapped() const { return mDecoded == nullptr; }
+  //! Memory held, mapped or decoded
+  size_t             bytes()    const { return mDecoded ? mDecodedBytes : mFileBytes; }
+
+private:
+  SampleBuffer( std::string path ) : mPath( std::move( path ) ), mFile(nullptr), mFileBytes(0),
+                                     mDecoded(nullptr), mDecodedBytes(0) {}
+
+  //! Format of the samples in the file
+  struct Format {
+    int    encoding   = 0; // 1 integer PCM, 3 float
+    int    bits       = 0;
+    int    channels   = 0;
+    double sampleRate = 0;
+    size_t offset     = 0; // first sample
+    size_t bytes      = 0; // sample data
+  };
+
+  bool load( std::string& error ) {
+    if ( !map( error ) ) return false;
+    auto const bytes = static_cast<const unsigned char *>( mFile );
+    Format format;
+    if ( mFileBytes >= 12 && !std::memcmp( bytes, "RIFF", 4 ) && !std::memcmp( bytes + 8, "WAVE", 4 ) ) {
+      if ( !parseWav( bytes, format, error ) ) return false;
+    } else {
+      // Anything else is a raw table of 32 bit floats
+      format.encoding = 3;
+      format.bits     = 32;
+      format.channels = 1;
+      format.bytes    = mFileBytes;
+    }
+
+    auto const frameBytes = size_t(format.channels) * (format.bits / 8);
+    mView.channels   = format.channels;
+    mView.sampleRate = format.sampleRate;
+    mView.frames     = frameBytes ? format.bytes / frameBytes : 0;
+    auto const samples = mView.frames * format.channels;
+
+    if ( format.encoding == 3 && format.bits == 32 && format.offset % alignof(float) == 0 && isLittleEndian() ) {
+      mView.data = reinterpret_cast<const float *>( bytes + format.offset );
+      return true;
+    }
+
+    mDecodedBytes = (samples * sizeof(float) + kPage - 1) / kPage * kPage;
+    mDecoded = static_cast<float *>( allocatePages( mDecodedBytes ) );
+    if ( samples && !mDecoded ) {
+      error = "out of memory";
+      return false;
+    }
+    if ( !decode( bytes + format.offset, samples, format, mDecoded ) ) {
+      error = "unsupported sample format";
+      return false;
+    }
+    mView.data = mDecoded;
+    // The decoded copy is all that's needed from now on
+    unmap();
+    return true;
+  }
+
+  bool parseWav( const unsigned char *bytes, Format& format, std::string& error ) {
+    bool haveFormat = false;
+    size_t pos = 12;
+    while ( pos + 8 <= mFileBytes ) {
+      auto const id   = bytes + pos;
+      auto const size = (size_t)readLE( bytes + pos + 4, 4 );
+      auto const body = bytes + pos + 8;
+      // Nothing is read from a chunk that claims to run past the file
+      if ( size > mFileBytes - pos - 8 ) {
+        error = "truncated WAV file";
+        return false;
+      }
+      if ( !std::memcmp( id, "fmt ", 4 ) && size >= 16 ) {
+        format.encoding   = (int)readLE( body, 2 );
+        format.channels   = (int)readLE( body + 2, 2 );
+        format.sampleRate = (double)readLE( body + 4, 4 );
+        format.bits       = (int)readLE( body + 14, 2 );
+        // WAVE_FORMAT_EXTENSIBLE keeps the real format in its sub format
+        if ( format.encoding == 0xFFFE && size >= 26 ) format.encoding = (int)readLE( body + 24, 2 );
+        haveFormat = true;
+      } else if ( !std::memcmp( id, "data", 4 ) ) {
+        if ( !haveFormat ) break;
+        format.offset = pos + 8;
+        format.bytes  = size;
+        if ( format.channels <= 0 || !isSupported( format ) ) {
+          error = "unsupported WAV format";
+          return false;
+        }
+        return true;
+      }
+      pos += 8 + size + (size & 1);
+    }
+    error = "not a valid WAV file";
+    return false;
+  }
+
+  //! Sample formats decode() handles: 8 to 32 bit integers, 32 and 64 bit floats
+  static bool isSupported( Format const& format ) {
+    switch ( format.encoding ) {
+      case 1:  return format.bits == 8 || format.bits == 16 || format.bits == 24 || format.bits == 32;
+      case 3:  return format.bits == 32 || format.bits == 64;
+      default: return false;
+    }
+  }
+
+  static bool decode( const unsigned char *in, size_t samples, Format const& format, float *out ) {
+    auto const width = format.bits / 8;
+    if ( format.encoding == 3 && format.bits == 32 ) {
+      for ( size_t i = 0; i < samples; i++ ) {
+        uint32_t v = (uint32_t)readLE( in + i * 4, 4 );
+        std::memcpy( out + i, &v, 4 );
+      }
+    } else if ( format.encoding == 3 && format.bits == 64 ) {
+      for ( size_t i = 0; i < samples; i++ ) {
+        uint64_t v = readLE( in + i * 8, 8 );
+        double d;
+        std::memcpy( &d, &v, 8 );
+        out[i] = (float)d;
+      }
+    } else if ( format.encoding == 1 && format.bits == 8 ) {
+      // 8 bit WAV is unsigned
+      for ( size_t i = 0; i < samples; i++ ) out[i] = (in[i] - 128) * (1.f / 128.f);
+    } else if ( format.encoding == 1 && width >= 2 && width <= 4 ) {
+      auto const shift = 32 - format.bits;
+      auto const scale = 1.f / 2147483648.f;
+      for ( size_t i = 0; i < samples; i++ ) {
+        // Shifted to the top of 32 bits to extend the sign
+        auto const v = (int32_t)(uint32_t)( readLE( in + i * width, width ) << shift );
+        out[i] = v * scale;
+      }
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  static uint64_t readLE( const unsigned char *p, int bytes ) {
+    uint64_t v = 0;
+    for ( int i = bytes - 1; i >= 0; i-- ) v = (v << 8) | p[i];
+    return v;
+  }
+
+  static bool isLittleEndian() {
+    uint16_t const probe = 1;
+    unsigned char first;
+    std::memcpy( &first, &probe, 1 );
+    return first == 1;
+  }
+
+  static constexpr size_t kPage = 4096;
+
+#ifdef _WIN32
+  // No mapping on Windows yet, the file is read into memory instead
+  bool map( std::string& error ) {
+    auto file = std::fopen( mPath.c_str(), "rb" );
+    if ( !file ) {
+      error = std::strerror( errno );
+      return false;
+    }
+    std::fseek( file, 0, SEEK_END );
+    auto const size = std::ftell( file );
+    std::fseek( file, 0, SEEK_SET );
+    mFileBytes = size > 0 ? (size_t)size : 0;
+    mFile = allocatePages( mFileBytes );
+    bool const ok = mFile && std::fread( mFile, 1, mFileBytes, file ) == mFileBytes;
+    std::fclose( file );
+    if ( !ok ) error = "read failed";
+    return ok;
+  }
+  void unmap() { freePages( mFile, mFileBytes ); mFile = nullptr; }
+  static void* allocatePages( size_t bytes ) { return _aligned_malloc( bytes ? bytes : 1, kPage ); }
+  static void  freePages( void *p, size_t ) { _aligned_free( p ); }
+#else
+  bool map( std::string& error ) {
+    auto const fd = open( mPath.c_str(), O_RDONLY );
+    if ( fd < 0 ) {
+      error = std::strerror( errno );
+      return false;
+    }
+    struct stat info;
+    if ( fstat( fd, &info ) != 0 || info.st_size <= 0 ) {
+      close( fd );
+      error = "empty file";
+      return false;
+    }
+    mFileBytes = (size_t)info.st_size;
+    mFile = mmap( nullptr, mFileBytes, PROT_READ, MAP_PRIVATE, fd, 0 );
+    // The mapping keeps the file open
+    close( fd );
+    if ( mFile == MAP_FAILED ) {
+      mFile = nullptr;
+      error = std::strerror( errno );
+      return false;
+    }
+    return true;
+  }
+  void unmap() {
+    if ( mFile ) munmap( mFile, mFileBytes );
+    mFile = nullptr;
+  }
+  static void* allocatePages( size_t bytes ) {
+    if ( bytes == 0 ) return nullptr;
+    auto p = mmap( nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+    return p == MAP_FAILED ? nullptr : p;
+  }
+  static void freePages( void *p, size_t bytes ) { if ( p ) munmap( p, bytes ); }
+#endif
+
+  void release() {
+    unmap();
+    freePages( mDecoded, mDecodedBytes );
+    mDecoded = nullptr;
+    mView    = SampleView();
+  }
+
+  std::string mPath;
+  void*       mFile;
+  size_t      mFileBytes;
+  float*      mDecoded;
+  size_t      mDecodedBytes;
+  SampleView  mView;
+};
+
+//! Handle an object keeps while it uses a buffer. The buffer is unmapped
+//  when the last handle to it goes
+using BufferRef = std::shared_ptr<const SampleBuffer>;
+
+//! Sound files and tables loaded by the objects in a binary, keyed by path.
+//  A file is loaded once however many objects ask for it. Loading can take
+//  a while for formats that need decoding, so call acquire() from defer()
+class BufferCache {
+public:
+  //! Never deleted, so buffers released at exit can still evict
+  static BufferCache& instance() {
+    static BufferCache *cache = new BufferCache;
+    return *cache;
+  }
+
+  //! Returns the buffer for path, loading it if no object holds it yet.
+  //  Callers asking for a file that is being loaded wait for that load.
+  //  Returns null and sets error if the file can't be loaded
+  BufferRef acquire( std::string const& path, std::string *error = nullptr ) {
+    auto const key = canonical( path );
+    std::promise<Load> promise;
+    {
+      std::unique_lock<std::mutex> guard( mLock );
+      auto& entry = mBuffers[key];
+      if ( auto buffer = entry.buffer.lock() ) return buffer;
+      if ( entry.loading.valid() ) {
+        auto loading = entry.loading;
+        guard.unlock();
+        return result( loading.get(), error );
+      }
+      entry.loading = promise.get_future().share();
+    }
+
+    // Loaded without the lock, so other files aren't held up
+    Load load;
+    std::unique_ptr<SampleBuffer> loaded( new SampleBuffer( key ) );
+    if ( loaded->load( load.error ) ) {
+      load.buffer = BufferRef( loaded.release(), [this]( const SampleBuffer *b ) { evict( b ); } );
+    } else {
+      load.error = path + ": " + load.error;
+    }
+    {
+      std::lock_guard<std::mutex> guard( mLock );
+      auto it = mBuffers.find( key );
+      if ( load.buffer ) {
+        it->second.buffer = load.buffer;
+        it->second.loading = {};
+      } else {
+        mBuffers.erase( it );
+      }
+    }
+    promise.set_value( load );
+    return result( load, error );
+  }
+
+  //! Number of files loaded or being loaded
+  size_t size() {
+    std::lock_guard<std::mutex> guard( mLock );
+    return mBuffers.size();
+  }
+
+private:
+  BufferCache() = default;
+
+  //! Outcome of loading a file, handed to everyone waiting for it
+  struct Load {
+    BufferRef   buffer;
+    std::string error;
+  };
+
+  //! A loaded file, or a load in progress
+  struct Entry {
+    std::weak_ptr<const SampleBuffer> buffer;
+    std::shared_future<Load>          loading;
+  };
+
+  static BufferRef result( Load const& load, std::string *error ) {
+    if ( !load.buffer && error ) *error = load.error;
+    return load.buffer;
+  }
+
+  void evict( const SampleBuffer *buffer ) {
+    {
+      std::lock_guard<std::mutex> guard( mLock );
+      auto it = mBuffers.find( buffer->path() );
+      // The entry may already hold a newer load of the same file
+      if ( it != mBuffers.end() && it->second.buffer.expired() && !it->second.loading.valid() ) {
+        mBuffers.erase( it );
+      }
+    }
+    delete buffer;
+  }
+
+  static std::string canonical( std::string const& path ) {
+#ifdef _WIN32
+    char resolved[_MAX_PATH];
+    return _fullpath( resolved, path.c_str(), _MAX_PATH ) ? std::string( resolved ) : path;
+#else
+    char resolved[PATH_MAX];
+    return realpath( path.c_str(), resolved ) ? std::string( resolved ) : path;
+#endif
+  }
+
+  std::mutex mLock;
+  std::unordered_map<std::string, Entry> mBuffers;
+};
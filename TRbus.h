@@ -0,0 +1,194 @@
+//
+//  TRbus.h
+//  TRextern
+//
+//  Copyright © 2026 Reactify. All rights reserved.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+//! Longest block a BlockBus carries. Define before including TRextern.h
+//  to change
+#ifndef TREXTERN_BUS_BLOCK
+#define TREXTERN_BUS_BLOCK 4096
+#endif
+
+//! Named channel shared by the objects in a binary
+class Bus {
+public:
+  virtual ~Bus() {}
+};
+
+//! One writer publishes a block of samples per DSP tick and any number of
+//  readers copy the latest one. Blocks go round a few slots, each guarded
+//  by a sequence lock: a reader only retries if the writer laps it, which
+//  takes several ticks, so neither side waits in practice. Neither side
+//  locks or allocates.
+template<class T>
+class BlockBus : public Bus {
+  static_assert( std::is_trivially_copyable<T>::value, "Bus samples must be plain data" );
+public:
+  static constexpr size_t kSlots = 4;
+
+  explicit BlockBus( size_t capacity = TREXTERN_BUS_BLOCK )
+  : mCapacity(capacity), mSamples(kSlots * capacity), mVersion(0) {}
+
+  //! Writer. Blocks longer than capacity() are cut short
+  void write( const T *samples, long size ) {
+    auto const count   = std::min( (size_t)std::max( size, 0L ), mCapacity );
+    auto const version = mVersion.load( std::memory_order_relaxed ) + 1;
+    auto& slot = mSlots[version % kSlots];
+    // Odd while being written
+    slot.sequence.store( 2 * version - 1, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_release );
+    std::copy( samples, samples + count, data( version ) );
+    slot.size.store( count, std::memory_order_relaxed );
+    slot.sequence.store( 2 * version, std::memory_order_release );
+    mVersion.store( version, std::memory_order_release );
+  }
+
+  //! Reader. Copies the latest block into out, zero filling what it
+  //  doesn't cover. Returns the number of samples copied, 0 before the
+  //  first write. version, if given, is set to the block's number
+  long read( T *out, long size, uint64_t *version = nullptr ) const {
+    auto const wanted = (size_t)std::max( size, 0L );
+    for ( ;; ) {
+      auto const latest = mVersion.load( std::memory_order_acquire );
+      if ( latest == 0 ) {
+        std::fill( out, out + wanted, T(0) );
+        if ( version ) *version = 0;
+        return 0;
+      }
+      auto const& slot   = mSlots[latest % kSlots];
+      auto const sequence = slot.sequence.load( std::memory_order_acquire );
+      // Lapped, the slot holds a later block by now
+      if ( sequence != 2 * latest ) continue;
+      auto const count = std::min( slot.size.load( std::memory_order_relaxed ), wanted );
+      auto const block = data( latest );
+      std::copy( block, block + count, out );
+      std::atomic_thread_fence( std::memory_order_acquire );
+      if ( slot.sequence.load( std::memory_order_relaxed ) != sequence ) continue;
+      std::fill( out + count, out + wanted, T(0) );
+      if ( version ) *version = latest;
+      return (long)count;
+    }
+  }
+
+  //! Number of blocks written. Readers compare it to tell a new block
+  //  from one they have already seen
+  uint64_t version()  const { return mVersion.load( std::memory_order_acquire ); }
+  size_t   capacity() const { return mCapacity; }
+
+private:
+  struct Slot {
+    std::atomic<uint64_t> sequence{0};
+    std::atomic<size_t>   size{0};
+  };
+
+  T*       data( uint64_t version )       { return mSamples.data() + (version % kSlots) * mCapacity; }
+  const T* data( uint64_t version ) const { return mSamples.data() + (version % kSlots) * mCapacity; }
+
+  size_t                mCapacity;
+  std::vector<T>        mSamples;
+  Slot                  mSlots[kSlots];
+  alignas(64) std::atomic<uint64_t> mVersion;
+};
+
+//! One writer publishes a snapshot of T, e.g. a set of parameters, and any
+//  number of readers copy the latest. Same scheme as BlockBus
+template<class T>
+class ValueBus : public Bus {
+  static_assert( std::is_trivially_copyable<T>::value, "Bus values must be plain data" );
+public:
+  static constexpr size_t kSlots = 4;
+
+  ValueBus() : mVersion(0) {}
+
+  //! Writer
+  void write( const T& value ) {
+    auto const version = mVersion.load( std::memory_order_relaxed ) + 1;
+    auto& slot = mSlots[version % kSlots];
+    slot.sequence.store( 2 * version - 1, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_release );
+    slot.value = value;
+    slot.sequence.store( 2 * version, std::memory_order_release );
+    mVersion.store( version, std::memory_order_release );
+  }
+
+  //! Reader. Copies the latest value and returns its number, or leaves
+  //  value alone and returns 0 before the first write
+  uint64_t read( T& value ) const {
+    for ( ;; ) {
+      auto const latest = mVersion.load( std::memory_order_acquire );
+      if ( latest == 0 ) return 0;
+      auto const& slot    = mSlots[latest % kSlots];
+      auto const sequence = slot.sequence.load( std::memory_order_acquire );
+      if ( sequence != 2 * latest ) continue;
+      T copy = slot.value;
+      std::atomic_thread_fence( std::memory_order_acquire );
+      if ( slot.sequence.load( std::memory_order_relaxed ) != sequence ) continue;
+      value = copy;
+      return latest;
+    }
+  }
+
+  uint64_t version() const { return mVersion.load( std::memory_order_acquire ); }
+
+private:
+  struct Slot {
+    std::atomic<uint64_t> sequence{0};
+    T                     value{};
+  };
+
+  Slot mSlots[kSlots];
+  alignas(64) std::atomic<uint64_t> mVersion;
+};
+
+//! Buses of the binary by name. Created on first use and never deleted,
+//  so objects can keep pointers to them
+class BusRegistry {
+public:
+  static BusRegistry& instance() {
+    static BusRegistry *registry = new BusRegistry;
+    return *registry;
+  }
+
+  //! Returns the bus called name, creating it if needed. Returns null if
+  //  the name is taken by a bus of another type. Takes a lock, so look
+  //  buses up in setup() and keep the pointer
+  template<class B>
+  B* get( std::string const& name ) {
+    std::lock_guard<std::mutex> guard( mLock );
+    auto& bus = mBuses[name];
+    if ( !bus ) bus.reset( new B );
+    return dynamic_cast<B *>( bus.get() );
+  }
+
+private:
+  BusRegistry() = default;
+
+  std::mutex mLock;
+  std::unordered_map<std::string, std::unique_ptr<Bus>> mBuses;
+};
+
+//------------------------------------------------------------------------------
+template<class T>
+BlockBus<T>* tr_blockbus( std::string const& name ) {
+  return BusRegistry::instance().get<BlockBus<T>>( name );
+}
+
+//------------------------------------------------------------------------------
+template<class T>
+ValueBus<T>* tr_valuebus( std::string const& name ) {
+  return BusRegistry::instance().get<ValueBus<T>>( name );
+}
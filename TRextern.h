@@ -8,25 +8,399 @@
 
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 #include <string>
-#ifdef PD
+#include <cstdlib>
+#include <type_traits>
+#include <array>
+#include <utility>
+#include <mutex>
+#include "TRqueue.h"
+#include "TRnumeric.h"
+#include "TRworker.h"
+#include "TRarena.h"
+#include "TRparallel.h"
+#include "TRblock.h"
+#include "TRoversample.h"
+#include "TRbuffer.h"
+#include "TRbus.h"
+#ifdef TREXTERN_PROFILE
+#include "TRprofile.h"
+#endif
+#if defined(TREXTERN_OFFLINE)
+// In-process Pd API for tests and benchmarks. Defines PD
+#include "TRoffline.h"
+#elif defined(PD)
 #include "m_pd.h"
 #else
 #include "ext.h"
 #include "z_dsp.h"
 #endif
 
-//! Pointer to class
-static t_class* m_class;
+//! Pd 0.54 and later can carry several channels per signal connection.
+//  Building against those headers makes the external require Pd 0.54;
+//  define TREXTERN_NO_MULTICHANNEL to keep supporting older versions.
+#if defined(PD) && defined(CLASS_MULTICHANNEL) && !defined(TREXTERN_NO_MULTICHANNEL)
+#define TREXTERN_PD_MULTICHANNEL 1
+#endif
+
+//! Host class and routines of one external class, see tr_externclass
+struct ExternClass;
 
-using InletRef  = std::shared_ptr<class Inlet>;
+//! Worker threads shared by all objects in the binary. Started by the
+//  first tr_initialise and never deleted; the threads end with the host
+inline WorkerPool* m_workers = nullptr;
+
+//! DSP threads shared by the parallel objects in the binary. Started by
+//  the first parallel object to prepare and never deleted
+inline DspPool* m_dsppool = nullptr;
+
+class TRextern;
+class Parameter;
+struct VirtualDispatch;
+template<class CLASS> struct StaticDispatch;
 using OutletRef = std::shared_ptr<class Outlet>;
 
+//! Inlet and outlet types. Cached as a tag when an inlet/outlet is created
+//  so type checks on the message path are a plain compare.
+enum class IOType { Bang, Int, Float, Symbol, List, Anything, Signal, Control, Count };
+
+//! Host symbols for each IOType, resolved once in tr_initialise
+inline t_symbol* m_iosymbols[(int)IOType::Count];
+
+inline t_symbol* tr_iosymbol( IOType type ) {
+  return m_iosymbols[(int)type];
+}
+
+//!
+#ifndef PD
+typedef void t_inlet;
+typedef void t_outlet;
+#endif
+
+struct NonCopyable {
+  NonCopyable & operator=(const NonCopyable&) = delete;
+  NonCopyable(const NonCopyable&) = delete;
+  NonCopyable() = default;
+};
+
+class Inlet : NonCopyable {
+  friend TRextern;
+public:
+  Inlet( Inlet&& other ) noexcept;
+  ~Inlet();
+  std::string   const&  getId()    const { return mId; }
+  t_symbol const*  getType()  const { return tr_iosymbol( mType ); }
+  IOType           getTypeTag() const { return mType; }
+  bool             isSignal() const { return mType == IOType::Signal; }
+  //! True for inlets taking lists or any message
+  bool             isMessage() const { return mType == IOType::List || mType == IOType::Anything; }
+  //! Parameter fed by this inlet, if any
+  Parameter*       getParameter() const { return mParameter; }
+protected:
+  //! Meant for internal instantation only
+  static Inlet create( t_inlet* inlet, IOType type, std::string identifier, Parameter* parameter = nullptr );
+  t_inlet*   mInlet;
+#ifdef PD
+  //! Receives the messages of list and anything inlets
+  t_pd*      mProxy;
+#endif
+private:
+  Inlet()    {};
+  std::string     mId;
+  IOType     mType;
+  Parameter* mParameter;
+};
+
+//! Non-owning handle to an inlet, passed by value to the receive callbacks.
+//  Refers to the owning object's inlet storage by index so copying it
+//  costs nothing and it stays valid while inlets are being added.
+class InletRef {
+public:
+  InletRef( const std::vector<Inlet>& inlets, size_t index ) : mInlets(&inlets), mIndex(index) {}
+  
+  const Inlet&  operator* () const { return (*mInlets)[mIndex]; }
+  const Inlet*  operator->() const { return &(*mInlets)[mIndex]; }
+  size_t        getIndex()   const { return mIndex; }
+  
+  bool operator==( const InletRef& other ) const { return mInlets == other.mInlets && mIndex == other.mIndex; }
+  bool operator!=( const InletRef& other ) const { return !(*this == other); }
+private:
+  const std::vector<Inlet>* mInlets;
+  size_t mIndex;
+};
+
+#ifdef PD
+#define TR_A_SYMBOL A_SYMBOL
+#else
+#define TR_A_SYMBOL A_SYM
+#endif
+
+//! Non-owning view of the atoms of a list or anything message. Points
+//  straight into the host's arguments, so it is only valid inside the
+//  callback; copy out what needs to be kept. Lists made only of floats,
+//  the common case, are read without checking each atom's type.
+class AtomSpan {
+public:
+  AtomSpan() : mAtoms(nullptr), mSize(0), mFloats(true) {}
+  AtomSpan( const t_atom *atoms, size_t size ) : mAtoms(atoms), mSize(size), mFloats(true) {
+    for ( size_t i = 0; i < size; i++ ) {
+      if ( atoms[i].a_type != A_FLOAT ) {
+        mFloats = false;
+        break;
+      }
+    }
+  }
+  
+  const t_atom* data()  const { return mAtoms; }
+  size_t        size()  const { return mSize; }
+  bool          empty() const { return mSize == 0; }
+  const t_atom* begin() const { return mAtoms; }
+  const t_atom* end()   const { return mAtoms + mSize; }
+  const t_atom& operator[]( size_t i ) const { return mAtoms[i]; }
+  
+  //! True if every atom is a float
+  bool          isFloats() const { return mFloats; }
+  bool          isNumber( size_t i ) const {
+#ifdef PD
+    return mAtoms[i].a_type == A_FLOAT;
+#else
+    return mAtoms[i].a_type == A_FLOAT || mAtoms[i].a_type == A_LONG;
+#endif
+  }
+  bool          isSymbol( size_t i ) const { return mAtoms[i].a_type == TR_A_SYMBOL; }
+  
+  //! Value of a number atom, 0 for anything else
+  t_sample      getFloat( size_t i ) const {
+    if ( mFloats || mAtoms[i].a_type == A_FLOAT ) return (t_sample)mAtoms[i].a_w.w_float;
+#ifndef PD
+    if ( mAtoms[i].a_type == A_LONG ) return (t_sample)mAtoms[i].a_w.w_long;
+#endif
+    return 0;
+  }
+  //! Symbol of a symbol atom, nullptr for anything else
+  t_symbol*     getSymbol( size_t i ) const {
+    if ( !isSymbol( i ) ) return nullptr;
+#ifdef PD
+    return mAtoms[i].a_w.w_symbol;
+#else
+    return mAtoms[i].a_w.w_sym;
+#endif
+  }
+  //! Copies up to count values, converted with getFloat(). Returns the
+  //  number of values copied
+  size_t        copyTo( t_sample *out, size_t count ) const {
+    if ( count > mSize ) count = mSize;
+    if ( mFloats ) {
+      for ( size_t i = 0; i < count; i++ ) out[i] = (t_sample)mAtoms[i].a_w.w_float;
+    } else {
+      for ( size_t i = 0; i < count; i++ ) out[i] = getFloat( i );
+    }
+    return count;
+  }
+  
+private:
+  const t_atom* mAtoms;
+  size_t        mSize;
+  bool          mFloats;
+};
+
+class Outlet : NonCopyable {
+  friend TRextern;
+public:
+  ~Outlet();
+  std::string   const  getId()    const;
+  t_symbol const* getType()  const { return tr_iosymbol( mType ); }
+  IOType          getTypeTag() const { return mType; }
+  void            sendBang() const;
+  void            sendFloat ( t_sample f )  const;
+  void            sendSymbol( t_symbol *s ) const;
+  //! Sends the atoms as they are, without copying
+  void            sendList( AtomSpan atoms ) const;
+  //! Sends values as a list of floats. The atoms are built in a buffer
+  //  kept by the outlet, so this only allocates when a list is longer
+  //  than any sent before
+  void            sendList( const t_sample *values, size_t count ) const;
+  void            sendAnything( t_symbol *selector, AtomSpan atoms ) const;
+  bool            isSignal() const { return mType == IOType::Signal; }
+protected:
+  //! Meant for internal instantation only
+  static OutletRef create( t_outlet* outlet, IOType type, std::string identifier );
+  t_outlet*    mOutlet;
+private:
+  Outlet()   {};
+  std::string     mId;
+  IOType     mType;
+  mutable std::vector<t_atom> mAtoms;
+};
+
+//! Smoothed control parameter fed by a float inlet. Incoming values are
+//  queued with their sample offset into the next block and rendered to
+//  per-sample values before process() runs, ramping linearly to each target.
+//  Parameters made with addInletParameter() follow a signal instead while
+//  one is connected.
+class Parameter : NonCopyable {
+  friend TRextern;
+public:
+  Parameter( t_sample initial, double rampMs );
+  
+  //! Control side. Queues a new target value. Returns false if the queue is full.
+  //  In Max, the main and scheduler threads take turns
+  bool            push( t_sample value );
+  //! Clamps pushed values. Call from setup()
+  void            setRange( t_sample min, t_sample max );
+  //! Ramp time for value changes. Call from setup()
+  void            setRamp( double rampMs ) { mRampMs = rampMs; }
+  
+  //! Audio side. Per-sample values for the current block
+  const t_sample* values()     const { return mOutput; }
+  //! Value at the end of the current block
+  t_sample        value()      const { return mValue; }
+  //! True if all values in the current block are equal to value()
+  bool            isConstant() const { return mConstant; }
+  //! True while a signal is connected to the parameter's inlet. values()
+  //  is then the signal itself, unclamped and without ramping
+  bool            isConnected() const { return mConnected; }
+  
+  // Do not call. Used internally. While unconnected, Pd's scalar value is
+  // read from the signal once per block
+  void            connect( bool connected ) { mConnected = connected; }
+  void            setSignal( const t_sample *signal ) { mSignal = signal; }
+  //! Points values() at a frame of an object with its own block size
+  void            adopt( const t_sample *values, long size );
+  
+protected:
+  void            prepare( double sampleRate, long blockSize );
+  void            render( long size );
+  
+private:
+  void            setTarget( t_sample value );
+  
+  struct Event {
+    t_sample value;
+    long     offset;
+  };
+  SpscQueue<Event, 256>  mEvents;
+#ifndef PD
+  //! Max pushes from the main and the scheduler thread
+  SpinLock               mPushLock;
+#endif
+  std::vector<t_sample>  mValues;
+  const t_sample*        mOutput;
+  const t_sample*        mSignal;
+  t_sample  mScalar;
+  bool      mConnected;
+  //! Copy the signal, for parallel objects whose process() runs after the
+  //  host has moved on
+  bool      mCopySignal;
+  t_sample  mCurrent;
+  //! Last of values(), which trails mCurrent in a frame of its own size
+  t_sample  mValue;
+  t_sample  mTarget;
+  t_sample  mStep;
+  t_sample  mMin;
+  t_sample  mMax;
+  double    mRampMs;
+  long      mRampSamples;
+  long      mRemaining;
+  bool      mConstant;
+  double    mBlockTime;
+};
+
+//! Results of deferred work waiting to be delivered on the main thread.
+//  Shared with the jobs still running, so it outlives its object
+struct DeferState {
+  DeferState() : alive(true), job(nullptr), direct(false)
+#ifdef PD
+  , clock(nullptr)
+#endif
+  {}
+  std::atomic<bool> alive;
+  //! Block in flight of a parallel object, finished before results are
+  //  delivered. Pd only, like the wait in tr_receive
+  ParallelJob*      job;
+  //! Delivered by the caller rather than the host, when there are no workers
+  bool              direct;
+  MpscQueue<std::unique_ptr<DeferTask>> done;
+#ifdef PD
+  t_clock* clock;
+#endif
+};
+
+//! Outlet messages process() can queue per object before some are dropped
+#ifndef TREXTERN_EVENT_CAPACITY
+#define TREXTERN_EVENT_CAPACITY 256
+#endif
+
+//! Message queued by process() for an outlet
+struct OutletEvent {
+  const Outlet* outlet;
+  IOType        type;
+  t_sample      value;
+  t_symbol*     symbol;
+  //! Host sample it is output at, counted from the start of the block it
+  //  was queued in
+  long          offset;
+  //! Logical time to deliver it at (Pd)
+  double        time;
+};
+
+//! Messages queued by process(). Gathered per block on the audio side,
+//  then passed to the main thread in one batch
+struct EventState {
+  EventState() : count(0), overflow(0), dropped(0),
+#ifdef PD
+  clock(nullptr), armed(false)
+#else
+  qelem(nullptr)
+#endif
+  {}
+  //! Audio side: this block's messages
+  std::array<OutletEvent, TREXTERN_EVENT_CAPACITY> block;
+  size_t   count;
+  uint32_t overflow;
+  //! Audio to main thread
+  SpscQueue<OutletEvent, TREXTERN_EVENT_CAPACITY> ring;
+  std::atomic<uint32_t> dropped;
+#ifdef PD
+  t_clock* clock;
+  //! Scheduler thread only
+  bool     armed;
+#else
+  void*    qelem;
+#endif
+};
+
+//! One multichannel signal inlet or outlet for the current block
+struct SignalBus {
+  //! One pointer per channel
+  t_sample* const* channels;
+  //! Channel-major samples when the host stores them contiguously (Pd),
+  //  channelCount * frames long. nullptr otherwise
+  t_sample*  data;
+  int        channelCount;
+  long       frames;
+  
+  t_sample*  channel( int c ) const { return channels[c]; }
+};
+
+//! Block of samples shared between objects, see BlockBus
+using SampleBus = BlockBus<t_sample>;
+
+//! Sample bus called name, shared by the objects in the binary. Null if
+//  the name is used by another kind of bus
+inline SampleBus* tr_samplebus( std::string const& name ) {
+  return tr_blockbus<t_sample>( name );
+}
+
 //! Base external object
 class TRextern {
 public:
+  //! How the host-facing routines call this class, see DispatchFor
+  using Dispatch = VirtualDispatch;
+
   TRextern();
   virtual ~TRextern();
   
@@ -34,6 +408,12 @@ public:
   virtual void  setup( int /*argc*/, t_atom* /*argv*/ ) {}
   //! Override to free resources before exit
   virtual void  exit() {}
+  //! Override to set up for DSP: compute coefficients, size tables etc.
+  //  Called whenever DSP is (re)built, before process() is registered
+  virtual void  prepare( double /*sampleRate*/, long /*maxBlockSize*/ ) {}
+  //! Override to undo prepare(). Called before the next prepare() and
+  //  before the object is deleted, if it was prepared
+  virtual void  release() {}
   //! Override to process audio
   virtual void  process( t_sample **const /*inBuffers*/, t_sample **const /*outBuffers*/, long /*size*/ ) {};
   //! Override to receive control values from inlets
@@ -41,12 +421,61 @@ public:
   virtual void  intReceived   ( InletRef /*inlet*/, long /*value*/ ) {}
   virtual void  floatReceived ( InletRef /*inlet*/, t_sample /*value*/ ) {}
   virtual void  symbolReceived( InletRef /*inlet*/, t_symbol* /*symbol*/ ) {}
+  //! Override to receive lists and other messages from list and anything
+  //  inlets. The atoms are only valid during the call
+  virtual void  listReceived    ( InletRef /*inlet*/, AtomSpan /*atoms*/ ) {}
+  virtual void  anythingReceived( InletRef /*inlet*/, t_symbol* /*selector*/, AtomSpan /*atoms*/ ) {}
 
   // Audio in/out
   virtual void  setupIO( int inChannels, int outChannels ) final;
   
+  //! Multichannel audio in/out. Each signal inlet and outlet carries any
+  //  number of channels, negotiated whenever DSP is (re)started.
+  //  Override processMultichannel() instead of process()
+  virtual void  setupMultichannelIO( int inlets, int outlets ) final;
+  virtual void  processMultichannel( const SignalBus* /*ins*/, SignalBus* /*outs*/, long /*size*/ ) {}
+  //! Override to choose the channel count of a signal outlet.
+  //  Defaults to the widest input
+  virtual int   outputChannelCount( int outlet, std::vector<int> const& inputChannels ) const;
+  
   int const& inChannelCount()  const { return mInChannels;  }
   int const& outChannelCount() const { return mOutChannels; }
+  bool       isMultichannel()  const { return mMultichannel; }
+  //! DSP settings passed to the last prepare(). 0 before DSP has started
+  double     sampleRate()   const { return mSampleRate; }
+  long       maxBlockSize() const { return mMaxBlockSize; }
+  
+  //! Flush denormals to zero while process() runs. Off by default, see
+  //  TREXTERN_FLUSH_DENORMALS
+  void       setFlushDenormals( bool flush ) { mFlushDenormals = flush; }
+  bool       flushesDenormals() const { return mFlushDenormals; }
+  
+  //! Runs process() on a DSP thread alongside the other parallel objects
+  //  in the binary, at the cost of one block of latency. Call from setup().
+  //  In Pd, callbacks wait for the block in flight, so they never overlap
+  //  process(). Max runs callbacks alongside the audio thread in any case,
+  //  so there they don't wait. Ignored for multichannel objects
+  void       setParallel( bool parallel ) { mParallel = parallel; }
+  bool       isParallel() const { return mParallel && !mMultichannel; }
+  
+  //! Runs process() on frames of a fixed size, e.g. a power of two for an
+  //  FFT, whatever the host's block size. Inputs and outputs are buffered,
+  //  adding latency() samples of delay. prepare() and maxBlockSize() see
+  //  the frame size. Call from setup(); 0 follows the host. Ignored for
+  //  multichannel objects
+  void       setProcessBlockSize( long size ) { mProcessBlockSize = size; }
+  long       processBlockSize() const { return mProcessBlockSize; }
+  //! Runs process() at 2, 4 or 8 times the sample rate, e.g. for
+  //  saturators that would alias otherwise. Inputs are upsampled and
+  //  outputs downsampled with halfband filters; parameter values are
+  //  held. prepare() sees the higher rate and block size. Call from
+  //  setup(); 1 turns it off. Ignored for multichannel objects
+  void       setOversampling( int factor ) { mOversampling = factor <= 1 ? 1 : factor <= 2 ? 2 : factor <= 4 ? 4 : 8; }
+  int        oversampling() const { return mOversampling; }
+  //! Samples of delay the framework adds to the outputs, from buffering
+  //  frames, oversampling and parallel processing. Valid once DSP has
+  //  started
+  long       latency() const { return mLatency; }
   
   //! Control in/out
   InletRef    addInletBang  ( std::string identifier );
@@ -54,14 +483,93 @@ public:
   //  which won't pass changes on to receivers below. TODO: passive inlets for Max?
   InletRef    addInletFloat ( std::string identifier, t_sample *f = nullptr );
   InletRef    addInletSymbol( std::string identifier, t_symbol *s = nullptr );
+  //! Lists go to listReceived(). Bangs, floats and symbols arrive as
+  //  lists of zero or one atoms, like they do for Pd's list objects
+  InletRef    addInletList    ( std::string identifier );
+  //! Like a list inlet, with any other message going to anythingReceived()
+  InletRef    addInletAnything( std::string identifier );
   
   OutletRef   addOutlet( std::string identifier );
   
-  const std::vector<InletRef>&  getInlets()  const { return mInlets; }
+  //! Smoothed parameter with its own float inlet. Read its values in process()
+  Parameter&  addParameter( std::string identifier, t_sample initial = 0, double rampMs = 0 );
+  //! Parameter with a signal inlet that also takes floats. process() sees
+  //  the signal while one is connected and the smoothed float values
+  //  otherwise; check isConnected() or isConstant() to pick a fast path.
+  //  Add it right after setupIO(), since hosts put signal inlets first.
+  //  Multichannel objects get a float inlet
+  Parameter&  addInletParameter( std::string identifier, t_sample initial = 0, double rampMs = 0 );
+  
+  //! Buffer for delay lines, scratch space or other DSP state, e.g.
+  //  `addBuffer<t_sample>( 2, ArenaScale::PerSecond )`. Call from setup().
+  //  All buffers share one cache aligned block, allocated when DSP starts
+  //  and reallocated only when the sample rate or block size changes
+  template<class T>
+  ArenaBuffer<T> addBuffer( double amount, ArenaScale scale = ArenaScale::Fixed ) {
+    return ArenaBuffer<T>( &mArena, mArena.reserve( sizeof(T), alignof(T), amount, scale ) );
+  }
+  
+  //! Send from process(). Messages are queued and sent on the main thread
+  //  in order: in Pd at the logical time sample offset of the current
+  //  process() call is output, so latency() included, in Max in one batch
+  //  per block. Offsets count samples of the frame and at the oversampled
+  //  rate, like process() does. Messages beyond TREXTERN_EVENT_CAPACITY
+  //  are dropped and reported
+  void        scheduleBang  ( OutletRef const& outlet, long offset = 0 );
+  void        scheduleFloat ( OutletRef const& outlet, t_sample value, long offset = 0 );
+  void        scheduleSymbol( OutletRef const& outlet, t_symbol *s, long offset = 0 );
+  
+  const std::vector<Inlet>&     getInlets()  const { return mInlets; }
   const std::vector<OutletRef>& getOutlets() const { return mOutlets; }
   
+  //! Builds with TREXTERN_PROFILE defined answer a `profile` message with
+  //  timing statistics for process() and message counts per inlet.
+  //  They are posted to the console unless an outlet is set here
+  void        setProfileOutlet( OutletRef outlet ) { mProfileOutlet = outlet; }
+  
+  //! Runs work on a worker thread and then calls done with its result on
+  //  the main thread, where outlets can be used. Use for file loading,
+  //  table building and other work too slow for the scheduler thread.
+  //  Results still pending when the object is deleted are dropped
+  template<class Work, class Done>
+  void        defer( Work work, Done done );
+  
   // Do not call. Used internally
   virtual void layoutInOuts() final;
+  bool         prepareDsp( double sampleRate, long blockSize );
+  void         releaseDsp();
+  void         prepareParameters( double sampleRate, long blockSize );
+  void         renderParameters( long size );
+  //! Parameter of each signal inlet, null for audio inputs
+  const std::vector<Parameter*>& signalInlets() const { return mSignalInlets; }
+  bool         hasSignalParameters() const { return mSignalInlets.size() > (size_t)mInChannels; }
+  t_sample**   routeInputs( t_sample **ins );
+  bool         isAdapting() const { return mAdapting; }
+  template<class Process>
+  void         processFrames( t_sample **ins, t_sample **outs, long size, Process&& process );
+  bool         isOversampling() const { return mOversampling > 1 && !mMultichannel; }
+  template<class Process>
+  void         processOversampled( t_sample **ins, t_sample **outs, long size, Process&& process );
+  Arena&       arena() { return mArena; }
+  void         setInputChannels( int inlet, int channels );
+  void         layoutBuses( long frames );
+  void         flushEvents();
+  void         deliverEvents();
+  void         syncParallel() { mJob.wait(); }
+  ParallelJob& parallelJob() { return mJob; }
+  ParallelBuffers<t_sample>& parallelBuffers() { return mParallelBuffers; }
+  SignalBus*   inputBuses()  { return mInputBuses.data(); }
+  SignalBus*   outputBuses() { return mOutputBuses.data(); }
+  t_sample**   busChannels() { return mBusChannels.data(); }
+#ifdef TREXTERN_CHECK_NUMERICS
+  void         checkNumerics( t_sample *const *outs, int count, long size, int outlet = -1 );
+#endif
+#ifdef TREXTERN_PROFILE
+  DspProfile&  profile() { return mProfile; }
+  void         countMessage( size_t inlet );
+  void         reportProfile();
+  void         resetProfile();
+#endif
   
 #ifdef PD
   t_object*   mObject; // Pointer to internal object-properties. Do not use.
@@ -70,76 +578,88 @@ public:
 #endif
   
   struct _external* mParent;
+  ExternClass*      mClass; // Class the object belongs to. Do not use.
   
 protected:
   
 private:
   //! Audio IO is handled internally
   InletRef   addInletSignal ( std::string identifier );
+  InletRef   addInletMessage( std::string identifier, IOType type );
+  void       scheduleEvent( OutletEvent const& event );
   OutletRef  addOutletSignal( std::string identifier );
   
   void    cleanup();
   int     mInChannels;
   int     mOutChannels;
-  std::vector<InletRef>  mInlets;
+  bool    mMultichannel;
+  bool    mPrepared;
+  double  mSampleRate;
+  long    mMaxBlockSize;
+  bool    mFlushDenormals;
+  bool    mParallel;
+  long    mProcessBlockSize;
+  bool    mAdapting;
+  long    mLatency;
+  //! Delay of the frames and oversampling in host samples, added to
+  //  scheduled messages
+  long    mEventDelay;
+  int     mOversampling;
+#ifdef TREXTERN_CHECK_NUMERICS
+  bool    mNumericsReported;
+#endif
+  std::vector<int>       mInputChannels;
+  std::vector<SignalBus> mInputBuses;
+  std::vector<SignalBus> mOutputBuses;
+  std::vector<t_sample*> mBusChannels;
+  std::vector<Inlet>     mInlets;
   std::vector<OutletRef> mOutlets;
-};
-
-
-//!
-#ifndef PD
-typedef void t_inlet;
-typedef void t_outlet;
+  std::vector<std::unique_ptr<Parameter>> mParameters;
+  std::vector<Parameter*> mSignalInlets;
+  std::vector<t_sample*>  mRoutedInputs;
+  Arena                  mArena;
+  OutletRef              mProfileOutlet;
+  std::shared_ptr<DeferState> mDeferState;
+  std::unique_ptr<EventState> mEvents;
+  ParallelJob            mJob;
+  ParallelBuffers<t_sample> mParallelBuffers;
+  BlockFifo<t_sample>    mFifo;
+  //! Inputs then parameter values of a block, as fed to mFifo
+  std::vector<t_sample*> mFifoInputs;
+  Oversampler<t_sample>  mOversampler;
+  //! Parameter values held at the higher rate, one block per parameter
+  std::vector<t_sample>  mHeldValues;
+#ifdef TREXTERN_PROFILE
+  DspProfile             mProfile;
+  std::vector<uint64_t>  mMessageCounts;
 #endif
-
-struct NonCopyable {
-  NonCopyable & operator=(const NonCopyable&) = delete;
-  NonCopyable(const NonCopyable&) = delete;
-  NonCopyable() = default;
 };
 
-class Inlet : NonCopyable {
-  friend TRextern;
+//! Optional CRTP base for compile-time dispatch. Declare an external as
+//  `class foo : public TRexternStatic<foo>` and TREXTERN_CREATE will call
+//  foo's callbacks directly through StaticDispatch<foo>, letting small
+//  process() kernels be inlined. Only the callbacks foo overrides are
+//  registered with the host.
+template<class Derived>
+class TRexternStatic : public TRextern {
 public:
-  ~Inlet();
-  std::string   const&  getId()    const { return mId; }
-  t_symbol const*  getType()  const { return mType; }
-  bool             isSignal() const;
-protected:
-  //! Meant for internal instantation only
-  static InletRef create( t_inlet* inlet, t_symbol* type, std::string identifier );
-  t_inlet*   mInlet;
-private:
-  Inlet()    {};
-  std::string     mId;
-  t_symbol*  mType;
+  using Dispatch = StaticDispatch<Derived>;
 };
 
-class Outlet : NonCopyable {
-  friend TRextern;
-public:
-  ~Outlet();
-  std::string   const  getId()    const;
-  t_symbol const* getType()  const { return mType; }
-  void            sendBang() const;
-  void            sendFloat ( t_sample f )  const;
-  void            sendSymbol( t_symbol *s ) const;
-  //void          sendList( t_symbol *s );
-  bool            isSignal() const;
-protected:
-  //! Meant for internal instantation only
-  static OutletRef create( t_outlet* outlet, t_symbol* type, std::string identifier );
-  t_outlet*    mOutlet;
-private:
-  Outlet()   {};
-  std::string     mId;
-  t_symbol*  mType;
-};
+//! Signal buffer pointers handed to process(). Built once per DSP rebuild
+//  in ext_dsp so the perform routine does no per-block bookkeeping.
+//  Input pointers are followed directly by output pointers in one block.
+typedef struct _channeltable {
+  t_sample**  ins;
+  t_sample**  outs;
+  size_t      capacity;
+} t_channeltable;
 
 //! Class dataspace
 typedef struct _external {
 #ifdef PD
   t_object    x_obj; // Internal object-properties
+  t_channeltable channels;
 #else
   t_pxobject  x_obj;
   long        m_in;  // space for the inlet number used by proxies
@@ -148,143 +668,483 @@ typedef struct _external {
 } t_external;
 
 
+//! Callback dispatch used by the host-facing routines below.
+//  VirtualDispatch goes through TRextern's vtable, StaticDispatch calls
+//  the concrete class directly.
+struct VirtualDispatch {
+  static constexpr bool hasProcess = true;
+  static constexpr bool hasProcessMultichannel = true;
+  static constexpr bool hasBang    = true;
+  static constexpr bool hasInt     = true;
+  static constexpr bool hasFloat   = true;
+  static constexpr bool hasSymbol  = true;
+  static constexpr bool hasList    = true;
+  static constexpr bool hasAnything = true;
+  
+  static void process( TRextern *impl, t_sample **const ins, t_sample **const outs, long size ) {
+    impl->process( ins, outs, size );
+  }
+  static void processMultichannel( TRextern *impl, const SignalBus *ins, SignalBus *outs, long size ) {
+    impl->processMultichannel( ins, outs, size );
+  }
+  static void bang  ( TRextern *impl, InletRef it )                { impl->bangReceived( it ); }
+  static void intv  ( TRextern *impl, InletRef it, long value )    { impl->intReceived( it, value ); }
+  static void floatv( TRextern *impl, InletRef it, t_sample value ){ impl->floatReceived( it, value ); }
+  static void symbol( TRextern *impl, InletRef it, t_symbol *s )   { impl->symbolReceived( it, s ); }
+  static void list  ( TRextern *impl, InletRef it, AtomSpan atoms ){ impl->listReceived( it, atoms ); }
+  static void anything( TRextern *impl, InletRef it, t_symbol *s, AtomSpan atoms ) {
+    impl->anythingReceived( it, s, atoms );
+  }
+};
+
+//! A callback is overridden when taking its address no longer yields TRextern's
+#define TREXTERN_OVERRIDES(CLASS, FUNC) \
+  (!std::is_same<decltype(&CLASS::FUNC), decltype(&TRextern::FUNC)>::value)
+
+template<class CLASS>
+struct StaticDispatch {
+  static constexpr bool hasProcess = TREXTERN_OVERRIDES(CLASS, process);
+  static constexpr bool hasProcessMultichannel = TREXTERN_OVERRIDES(CLASS, processMultichannel);
+  static constexpr bool hasBang    = TREXTERN_OVERRIDES(CLASS, bangReceived);
+  static constexpr bool hasInt     = TREXTERN_OVERRIDES(CLASS, intReceived);
+  static constexpr bool hasFloat   = TREXTERN_OVERRIDES(CLASS, floatReceived);
+  static constexpr bool hasSymbol  = TREXTERN_OVERRIDES(CLASS, symbolReceived);
+  static constexpr bool hasList    = TREXTERN_OVERRIDES(CLASS, listReceived);
+  static constexpr bool hasAnything = TREXTERN_OVERRIDES(CLASS, anythingReceived);
+  
+  static CLASS* self( TRextern *impl ) {
+    static_assert( std::is_base_of<TRexternStatic<CLASS>, CLASS>::value,
+                   "StaticDispatch<CLASS> needs CLASS to derive from TRexternStatic<CLASS>" );
+    return static_cast<CLASS *>(impl);
+  }
+  
+  static void process( TRextern *impl, t_sample **const ins, t_sample **const outs, long size ) {
+    self(impl)->CLASS::process( ins, outs, size );
+  }
+  static void processMultichannel( TRextern *impl, const SignalBus *ins, SignalBus *outs, long size ) {
+    self(impl)->CLASS::processMultichannel( ins, outs, size );
+  }
+  static void bang  ( TRextern *impl, InletRef it )                { self(impl)->CLASS::bangReceived( it ); }
+  static void intv  ( TRextern *impl, InletRef it, long value )    { self(impl)->CLASS::intReceived( it, value ); }
+  static void floatv( TRextern *impl, InletRef it, t_sample value ){ self(impl)->CLASS::floatReceived( it, value ); }
+  static void symbol( TRextern *impl, InletRef it, t_symbol *s )   { self(impl)->CLASS::symbolReceived( it, s ); }
+  static void list  ( TRextern *impl, InletRef it, AtomSpan atoms ){ self(impl)->CLASS::listReceived( it, atoms ); }
+  static void anything( TRextern *impl, InletRef it, t_symbol *s, AtomSpan atoms ) {
+    self(impl)->CLASS::anythingReceived( it, s, atoms );
+  }
+};
+
+//! The dispatch a class inherits: VirtualDispatch from TRextern,
+//  StaticDispatch<CLASS> from TRexternStatic<CLASS>
+template<class CLASS>
+using DispatchFor = typename CLASS::Dispatch;
+
+//! Runs process() on a block, through the frame FIFO and the oversampler
+//  when the object uses them
+template<class D>
+inline void tr_processblock( TRextern *impl, t_sample **ins, t_sample **outs, long size ) {
+  auto run = [impl]( t_sample **ins, t_sample **outs, long size ) {
+    if ( impl->isOversampling() ) {
+      impl->processOversampled( ins, outs, size, [impl]( t_sample **ins, t_sample **outs, long size ) {
+        D::process( impl, ins, outs, size );
+      } );
+    } else {
+      D::process( impl, ins, outs, size );
+    }
+  };
+  if ( impl->isAdapting() ) {
+    impl->processFrames( ins, outs, size, run );
+  } else {
+    run( ins, outs, size );
+  }
+}
+
+//! Runs one block of audio. Denormals are flushed for the whole block when
+//  the object asks for it. Building with TREXTERN_CHECK_NUMERICS defined
+//  also scans the outputs for NaN, Inf and denormals afterwards
+template<class D>
+inline void tr_process( TRextern *impl, t_sample **ins, t_sample **outs, long size ) {
+#ifdef TREXTERN_PROFILE
+  auto const start = tr_ticks();
+#endif
+  {
+    DenormalGuard guard( impl->flushesDenormals() );
+#ifdef TREXTERN_ALLOC_TRAP
+    AllocationTrap trap;
+#endif
+    impl->renderParameters( size );
+    tr_processblock<D>( impl, ins, outs, size );
+  }
+  impl->flushEvents();
+#ifdef TREXTERN_PROFILE
+  impl->profile().record( tr_ticks() - start, size );
+#endif
+#ifdef TREXTERN_CHECK_NUMERICS
+  impl->checkNumerics( outs, impl->outChannelCount(), size );
+#endif
+}
+
+//------------------------------------------------------------------------------
+template<class D>
+inline void tr_processmultichannel( TRextern *impl, long size ) {
+#ifdef TREXTERN_PROFILE
+  auto const start = tr_ticks();
+#endif
+  {
+    DenormalGuard guard( impl->flushesDenormals() );
+#ifdef TREXTERN_ALLOC_TRAP
+    AllocationTrap trap;
+#endif
+    impl->renderParameters( size );
+    D::processMultichannel( impl, impl->inputBuses(), impl->outputBuses(), size );
+  }
+  impl->flushEvents();
+#ifdef TREXTERN_PROFILE
+  impl->profile().record( tr_ticks() - start, size );
+#endif
+#ifdef TREXTERN_CHECK_NUMERICS
+  for ( auto i = 0; i < impl->outChannelCount(); i++ ) {
+    auto& bus = impl->outputBuses()[i];
+    impl->checkNumerics( bus.channels, bus.channelCount, size, i );
+  }
+#endif
+}
+
+//------------------------------------------------------------------------------
+//! One offloaded block of a parallel object, run by a DSP thread or by
+//  the audio thread when no thread got to it in time
+template<class D>
+void tr_processjob( void *context ) {
+  auto impl = static_cast<TRextern *>( context );
+  auto& buffers = impl->parallelBuffers();
+#ifdef TREXTERN_PROFILE
+  auto const start = tr_ticks();
+#endif
+  {
+    DenormalGuard guard( impl->flushesDenormals() );
+#ifdef TREXTERN_ALLOC_TRAP
+    AllocationTrap trap;
+#endif
+    tr_processblock<D>( impl, buffers.ins(), buffers.outs(), buffers.size() );
+  }
+#ifdef TREXTERN_PROFILE
+  impl->profile().record( tr_ticks() - start, buffers.size() );
+#endif
+}
+
+//------------------------------------------------------------------------------
+//! Audio thread side of a parallel object. Finishes the previous block,
+//  hands this block to the DSP threads and outputs the previous result.
+//  Parameters are rendered here so they follow the host's timing
+template<class D>
+inline void tr_processparallel( TRextern *impl, t_sample **ins, t_sample **outs, long size ) {
+  auto& job = impl->parallelJob();
+  auto& buffers = impl->parallelBuffers();
+  job.wait();
+  // Messages from the previous block go out a block late, like its audio
+  impl->flushEvents();
+  {
+    DenormalGuard guard( impl->flushesDenormals() );
+    impl->renderParameters( size );
+  }
+  buffers.stage( ins, size );
+  if ( !m_dsppool->submit( &job ) ) job.wait();
+  buffers.collect( outs, size );
+#ifdef TREXTERN_CHECK_NUMERICS
+  impl->checkNumerics( outs, impl->outChannelCount(), size );
+#endif
+}
+
+//------------------------------------------------------------------------------
+//! Called by every receiver before the callback. In Pd, finishes the
+//  block a parallel object has in flight, so callbacks never overlap
+//  process(). Max calls receivers from the main and scheduler threads
+//  while the audio thread goes on to the next block, so waiting there
+//  would only run process() off the audio thread
+inline void tr_receive( TRextern *impl, size_t inlet ) {
+#ifdef PD
+  impl->syncParallel();
+#endif
+#ifdef TREXTERN_PROFILE
+  impl->countMessage( inlet );
+#else
+  (void)inlet;
+#endif
+}
+
+//------------------------------------------------------------------------------
+//! Delivers a message arriving at a list or anything inlet. A null
+//  selector stands for a list
+template<class D>
+void tr_messagein( TRextern *impl, size_t inlet, t_symbol *s, int argc, const t_atom *argv ) {
+  InletRef it( impl->getInlets(), inlet );
+  AtomSpan atoms( argv, argc > 0 ? (size_t)argc : 0 );
+  if ( !s || s == tr_iosymbol( IOType::List ) ) {
+    D::list( impl, it, atoms );
+  } else if ( it->getTypeTag() == IOType::Anything ) {
+    D::anything( impl, it, s, atoms );
+  } else {
+    post("Inlet expects %s", it->getType()->s_name);
+  }
+}
+
 // Forward declarations and class methods
-void *ext_new( t_symbol *s, int argc, t_atom *argv );
+void  ext_eventsdue( TRextern *impl );
 #ifdef PD
 void  ext_dsp( t_external *x, t_signal **sp );
 
-//! Bang receivers
-typedef void (*t_bangfunc) (t_external *);
-#define addBangFunc(num) \
-void ext_bangin_##num( t_external *x ) { \
-  auto impl = x->impl; \
-  impl->bangReceived( impl->getInlets()[num-1] ); \
-}
-addBangFunc(1)
-addBangFunc(2)
-addBangFunc(3)
-addBangFunc(4)
-addBangFunc(5)
-addBangFunc(6)
-addBangFunc(7)
-static std::vector<t_bangfunc> bangfuncs = {
-  ext_bangin_1,
-  ext_bangin_2,
-  ext_bangin_3,
-  ext_bangin_4,
-  ext_bangin_5,
-  ext_bangin_6,
-  ext_bangin_7
-};
-
-//! Float receivers
-typedef void (*t_floatfunc)(t_external *, t_sample);
-#define addFloatFunc(num) \
-void ext_floatin_##num( t_external *x, t_sample f ) { \
-  auto impl = x->impl; \
-  impl->floatReceived( impl->getInlets()[num-1], f ); \
-}
-addFloatFunc(1)
-addFloatFunc(2)
-addFloatFunc(3)
-addFloatFunc(4)
-addFloatFunc(5)
-addFloatFunc(6)
-addFloatFunc(7)
-static std::vector<t_floatfunc> floatfuncs = {
-  ext_floatin_1,
-  ext_floatin_2,
-  ext_floatin_3,
-  ext_floatin_4,
-  ext_floatin_5,
-  ext_floatin_6,
-  ext_floatin_7
-};
+//! Number of receivers generated per message type. Pd can't tell which
+//  inlet a message arrived on, so every inlet needs its own method.
+//  Define before including TRextern.h to change.
+#ifndef TREXTERN_MAX_INLETS
+#define TREXTERN_MAX_INLETS 128
+#endif
 
-//! Symbol receivers
+//! Receivers
+typedef void (*t_bangfunc)  (t_external *);
+typedef void (*t_floatfunc) (t_external *, t_sample);
 typedef void (*t_symbolfunc)(t_external *, t_symbol*);
-#define addSymbolFunc(num) \
-void ext_symbolin_##num( t_external *x, t_symbol* s ) { \
-  auto impl = x->impl; \
-  impl->symbolReceived( impl->getInlets()[num-1], s ); \
-}
-addSymbolFunc(1)
-addSymbolFunc(2)
-addSymbolFunc(3)
-addSymbolFunc(4)
-addSymbolFunc(5)
-addSymbolFunc(6)
-addSymbolFunc(7)
-static std::vector<t_symbolfunc> symbolfuncs = {
-  ext_symbolin_1,
-  ext_symbolin_2,
-  ext_symbolin_3,
-  ext_symbolin_4,
-  ext_symbolin_5,
-  ext_symbolin_6,
-  ext_symbolin_7
+
+template<class D, size_t I>
+void ext_bangin( t_external *x ) {
+  auto impl = x->impl;
+  tr_receive( impl, I );
+  D::bang( impl, InletRef( impl->getInlets(), I ) );
+}
+
+template<class D, size_t I>
+void ext_floatin( t_external *x, t_sample f ) {
+  auto impl = x->impl;
+  tr_receive( impl, I );
+  D::floatv( impl, InletRef( impl->getInlets(), I ), f );
+}
+
+template<class D, size_t I>
+void ext_symbolin( t_external *x, t_symbol* s ) {
+  auto impl = x->impl;
+  tr_receive( impl, I );
+  D::symbol( impl, InletRef( impl->getInlets(), I ), s );
+}
+
+//! One receiver per inlet index, generated at compile time
+template<class D>
+struct Trampolines {
+  static constexpr size_t size = TREXTERN_MAX_INLETS;
+  
+  template<size_t... I>
+  static std::array<t_bangfunc, size> bangs( std::index_sequence<I...> ) {
+    return {{ ext_bangin<D, I>... }};
+  }
+  template<size_t... I>
+  static std::array<t_floatfunc, size> floats( std::index_sequence<I...> ) {
+    return {{ ext_floatin<D, I>... }};
+  }
+  template<size_t... I>
+  static std::array<t_symbolfunc, size> symbols( std::index_sequence<I...> ) {
+    return {{ ext_symbolin<D, I>... }};
+  }
+  
+  static const std::array<t_bangfunc,   size> bang;
+  static const std::array<t_floatfunc,  size> floatv;
+  static const std::array<t_symbolfunc, size> symbol;
 };
 
+template<class D>
+const std::array<t_bangfunc, Trampolines<D>::size> Trampolines<D>::bang =
+  Trampolines<D>::bangs( std::make_index_sequence<Trampolines<D>::size>() );
+template<class D>
+const std::array<t_floatfunc, Trampolines<D>::size> Trampolines<D>::floatv =
+  Trampolines<D>::floats( std::make_index_sequence<Trampolines<D>::size>() );
+template<class D>
+const std::array<t_symbolfunc, Trampolines<D>::size> Trampolines<D>::symbol =
+  Trampolines<D>::symbols( std::make_index_sequence<Trampolines<D>::size>() );
+
+//! Parameter inlets bypass the callbacks and feed the parameter directly
+template<size_t I>
+void ext_parameterin( t_external *x, t_sample f ) {
+  tr_receive( x->impl, I );
+  x->impl->getInlets()[I].getParameter()->push( f );
+}
+
+template<size_t... I>
+std::array<t_floatfunc, TREXTERN_MAX_INLETS> tr_parametertable( std::index_sequence<I...> ) {
+  return {{ ext_parameterin<I>... }};
+}
+
+inline const std::array<t_floatfunc, TREXTERN_MAX_INLETS> parameterfuncs =
+  tr_parametertable( std::make_index_sequence<TREXTERN_MAX_INLETS>() );
+
+//! List and anything inlets deliver to a proxy that knows its inlet,
+//  since a Pd inlet can only translate a single selector
+typedef struct _inletproxy {
+  t_pd      pd;
+  TRextern* impl;
+  size_t    index;
+} t_inletproxy;
+
+//! Bangs, floats and symbols reach the list method as short lists
+template<class D>
+void ext_proxylist( t_inletproxy *x, t_symbol* /*s*/, int argc, t_atom *argv ) {
+  tr_receive( x->impl, x->index );
+  tr_messagein<D>( x->impl, x->index, nullptr, argc, argv );
+}
+
+template<class D>
+void ext_proxyanything( t_inletproxy *x, t_symbol *s, int argc, t_atom *argv ) {
+  tr_receive( x->impl, x->index );
+  tr_messagein<D>( x->impl, x->index, s, argc, argv );
+}
+
+//! Returns false and reports if no receiver is left for another inlet
+inline bool tr_checkinletcount( t_object *obj, size_t idx, std::string const& identifier ) {
+  if ( idx < TREXTERN_MAX_INLETS ) return true;
+  pd_error( obj, "Can't create inlet '%s': limit of %d inlets reached (see TREXTERN_MAX_INLETS)",
+            identifier.c_str(), TREXTERN_MAX_INLETS );
+  return false;
+}
+
 #else // Max
 
-InletRef inletFromProxy( t_external *x ) {
+inline InletRef inletFromProxy( t_external *x ) {
   auto idx = proxy_getinlet((t_object *)x);
-  return x->impl->getInlets()[idx];
+  return InletRef( x->impl->getInlets(), idx );
 }
 
+template<class D>
 void ext_bangin( t_external *x ) {
   auto it = inletFromProxy(x);
-  if ( it->getType() == gensym("bang") ) {
-    x->impl->bangReceived( it );
+  tr_receive( x->impl, it.getIndex() );
+  if ( it->getTypeTag() == IOType::Bang ) {
+    D::bang( x->impl, it );
+  } else if ( it->isMessage() ) {
+    tr_messagein<D>( x->impl, it.getIndex(), nullptr, 0, nullptr );
   } else {
     post("Inlet expects %s", it->getType()->s_name);
   }
 }
 
+template<class D>
 void ext_floatin( t_external *x, t_sample value ) {
   auto it = inletFromProxy(x);
-  if ( it->getType() == gensym("float") ) {
-    x->impl->floatReceived( it, value );
+  tr_receive( x->impl, it.getIndex() );
+  if ( auto param = it->getParameter() ) {
+    param->push( value );
+  } else if ( it->getTypeTag() == IOType::Float && D::hasFloat ) {
+    D::floatv( x->impl, it, value );
+  } else if ( it->isMessage() ) {
+    t_atom a;
+    atom_setfloat( &a, value );
+    tr_messagein<D>( x->impl, it.getIndex(), nullptr, 1, &a );
   } else {
     post("Inlet expects %s", it->getType()->s_name);
   }
 }
 
+template<class D>
 void ext_intin( t_external *x, long value ) {
   auto it = inletFromProxy(x);
-  if ( it->getType() == gensym("int") ) {
-    x->impl->intReceived( it, value );
+  tr_receive( x->impl, it.getIndex() );
+  if ( auto param = it->getParameter() ) {
+    param->push( value );
+  } else if ( it->getTypeTag() == IOType::Int ) {
+    D::intv( x->impl, it, value );
+  } else if ( it->isMessage() ) {
+    t_atom a;
+    atom_setlong( &a, value );
+    tr_messagein<D>( x->impl, it.getIndex(), nullptr, 1, &a );
   } else {
     post("Inlet expects %s", it->getType()->s_name);
   }
 }
 
+template<class D>
 void ext_symbolin( t_external *x, t_symbol *s ) {
   auto it = inletFromProxy(x);
-  if ( it->getType() == gensym("symbol") ) {
-    x->impl->symbolReceived( it, s );
+  tr_receive( x->impl, it.getIndex() );
+  if ( it->getTypeTag() == IOType::Symbol ) {
+    D::symbol( x->impl, it, s );
+  } else if ( it->isMessage() ) {
+    t_atom a;
+    atom_setsym( &a, s );
+    tr_messagein<D>( x->impl, it.getIndex(), nullptr, 1, &a );
+  } else {
+    post("Inlet expects %s", it->getType()->s_name);
+  }
+}
+
+template<class D>
+void ext_listin( t_external *x, t_symbol* /*s*/, long argc, t_atom *argv ) {
+  auto it = inletFromProxy(x);
+  tr_receive( x->impl, it.getIndex() );
+  if ( it->isMessage() ) {
+    tr_messagein<D>( x->impl, it.getIndex(), nullptr, (int)argc, argv );
   } else {
     post("Inlet expects %s", it->getType()->s_name);
   }
 }
 
+template<class D>
+void ext_anythingin( t_external *x, t_symbol *s, long argc, t_atom *argv ) {
+  auto it = inletFromProxy(x);
+  tr_receive( x->impl, it.getIndex() );
+  if ( it->isMessage() ) {
+    tr_messagein<D>( x->impl, it.getIndex(), s, (int)argc, argv );
+  } else {
+    post("Inlet expects %s", it->getType()->s_name);
+  }
+}
 #endif
 
+//! Host class of one external class and the routines registered for it.
+//  Every class has its own, so one binary can register many classes
+struct ExternClass {
+  t_class* cls = nullptr;
+  //! Runs one offloaded block of a parallel object
+  void (*processjob)( void * ) = nullptr;
+#ifdef PD
+  //! Perform routines registered by ext_dsp
+  t_perfroutine perform             = nullptr;
+  t_perfroutine performmultichannel = nullptr;
+  t_perfroutine performparallel     = nullptr;
+  //! Receives the messages of list and anything inlets
+  t_class* proxyclass = nullptr;
+  //! Receiver tables. Callbacks a static class doesn't override are left
+  //  empty and never registered
+  const t_bangfunc*   bangfuncs   = nullptr;
+  const t_floatfunc*  floatfuncs  = nullptr;
+  const t_symbolfunc* symbolfuncs = nullptr;
+#endif
+};
+
+//! State of CLASS. Filled in by tr_initialise<CLASS>
+template<class CLASS>
+ExternClass& tr_externclass() {
+  static ExternClass state;
+  return state;
+}
+
 
 //! TRextern Implmentation
 
 //------------------------------------------------------------------------------
-TRextern::TRextern() : mInChannels(0), mOutChannels(0) {}
+inline TRextern::TRextern() : mParent(nullptr), mClass(nullptr), mInChannels(0), mOutChannels(0), mMultichannel(false), mPrepared(false),
+                       mSampleRate(0), mMaxBlockSize(0), mFlushDenormals(TREXTERN_FLUSH_DENORMALS != 0), mParallel(false),
+                       mProcessBlockSize(0), mAdapting(false), mLatency(0), mEventDelay(0),
+                       mOversampling(1)
+#ifdef TREXTERN_CHECK_NUMERICS
+, mNumericsReported(false)
+#endif
+{}
 
 //------------------------------------------------------------------------------
-TRextern::~TRextern() {
+inline TRextern::~TRextern() {
   cleanup();
 }
 
 //------------------------------------------------------------------------------
-void TRextern::setupIO( int inChannels, int outChannels ) {
+inline void TRextern::setupIO( int inChannels, int outChannels ) {
 #ifdef PD
-  class_addmethod( m_class, (t_method)ext_dsp, gensym("dsp"), A_NULL );
+  class_addmethod( mClass->cls, (t_method)ext_dsp, gensym("dsp"), A_NULL );
 #else
   // Max dsp setup happens in layoutInOuts()
 #endif
@@ -302,150 +1162,846 @@ void TRextern::setupIO( int inChannels, int outChannels ) {
 }
 
 //------------------------------------------------------------------------------
-InletRef TRextern::addInletBang( std::string identifier ) {
+inline void TRextern::setupMultichannelIO( int inlets, int outlets ) {
+  // Same inlets and outlets as single channel IO, one per connection
+  setupIO( inlets, outlets );
+  mMultichannel = true;
+  mInputChannels.assign( inlets, 1 );
+}
+
+//------------------------------------------------------------------------------
+inline int TRextern::outputChannelCount( int /*outlet*/, std::vector<int> const& inputChannels ) const {
+  int channels = 1;
+  for ( auto c : inputChannels ) {
+    if ( c > channels ) channels = c;
+  }
+  return channels;
+}
+
+//------------------------------------------------------------------------------
+inline void TRextern::setInputChannels( int inlet, int channels ) {
+  if ( inlet >= 0 && inlet < (int)mInputChannels.size() ) {
+    mInputChannels[inlet] = channels > 0 ? channels : 1;
+  }
+}
+
+//------------------------------------------------------------------------------
+inline void TRextern::layoutBuses( long frames ) {
+  mInputBuses.resize( mInChannels );
+  mOutputBuses.resize( mOutChannels );
+  
+  size_t total = 0;
+  for ( auto i = 0; i < mInChannels; i++ ) {
+    mInputBuses[i].channelCount = mInputChannels[i];
+    total += mInputChannels[i];
+  }
+  for ( auto i = 0; i < mOutChannels; i++ ) {
+    auto channels = outputChannelCount( i, mInputChannels );
+    mOutputBuses[i].channelCount = channels > 0 ? channels : 1;
+    total += mOutputBuses[i].channelCount;
+  }
+  mBusChannels.assign( total, nullptr );
+  
+  // Channel pointers are filled in by the host specific DSP routines
+  auto channels = mBusChannels.data();
+  for ( auto& bus : mInputBuses ) {
+    bus.channels = channels;
+    bus.data     = nullptr;
+    bus.frames   = frames;
+    channels    += bus.channelCount;
+  }
+  for ( auto& bus : mOutputBuses ) {
+    bus.channels = channels;
+    bus.data     = nullptr;
+    bus.frames   = frames;
+    channels    += bus.channelCount;
+  }
+}
+
+//------------------------------------------------------------------------------
+inline InletRef TRextern::addInletBang( std::string identifier ) {
   t_inlet* it = nullptr;
 #ifdef PD
   auto idx    = mInlets.size();
-  auto symbol = gensym(("ext_bangin_" + std::to_string(idx+1)).c_str());
-  auto func   = (t_method)bangfuncs[idx];
-  class_addmethod( m_class, func, symbol, A_NULL );
-  it = inlet_new( mObject, &mObject->ob_pd, &s_bang, symbol );
+  if ( tr_checkinletcount( mObject, idx, identifier ) ) {
+    auto symbol = gensym(("ext_bangin_" + std::to_string(idx+1)).c_str());
+    if ( auto bangfuncs = mClass->bangfuncs ) {
+      class_addmethod( mClass->cls, (t_method)bangfuncs[idx], symbol, A_NULL );
+    }
+    it = inlet_new( mObject, &mObject->ob_pd, &s_bang, symbol );
+  }
 #endif
-  mInlets.push_back( Inlet::create( it, gensym("bang"), identifier ) );
-  return mInlets.back();
+  mInlets.push_back( Inlet::create( it, IOType::Bang, identifier ) );
+  return InletRef( mInlets, mInlets.size() - 1 );
 }
 
 //------------------------------------------------------------------------------
-InletRef TRextern::addInletFloat( std::string identifier, t_sample *f ) {
+inline InletRef TRextern::addInletFloat( std::string identifier, t_sample *f ) {
   t_inlet* it = nullptr;
 #ifdef PD
   if ( f ) {
     it = floatinlet_new( mObject, f );
-  } else {
+  } else if ( tr_checkinletcount( mObject, mInlets.size(), identifier ) ) {
     auto idx    = mInlets.size();
     auto symbol = gensym(("ext_floatin_" + std::to_string(idx+1)).c_str());
-    auto func   = (t_method)floatfuncs[idx];
-    class_addmethod( m_class, func, symbol, A_FLOAT, A_NULL );
+    if ( auto floatfuncs = mClass->floatfuncs ) {
+      class_addmethod( mClass->cls, (t_method)floatfuncs[idx], symbol, A_FLOAT, A_NULL );
+    }
     it = inlet_new( mObject, &mObject->ob_pd, &s_float, symbol );
   }
 #endif
-  mInlets.push_back( Inlet::create( it, gensym("float"), identifier ) );
-  return mInlets.back();
+  mInlets.push_back( Inlet::create( it, IOType::Float, identifier ) );
+  return InletRef( mInlets, mInlets.size() - 1 );
 }
 
 //------------------------------------------------------------------------------
-InletRef TRextern::addInletSymbol( std::string identifier, t_symbol* s ) {
+inline InletRef TRextern::addInletSymbol( std::string identifier, t_symbol* s ) {
   t_inlet* it = nullptr;
 #ifdef PD
   if ( s ) {
     it = symbolinlet_new( mObject, &s );
-  } else {
+  } else if ( tr_checkinletcount( mObject, mInlets.size(), identifier ) ) {
     auto idx    = mInlets.size();
     auto symbol = gensym(("ext_symbolin_" + std::to_string(idx+1)).c_str());
-    auto func   = (t_method)symbolfuncs[idx];
-    class_addmethod( m_class, func, symbol, A_SYMBOL, A_NULL );
+    if ( auto symbolfuncs = mClass->symbolfuncs ) {
+      class_addmethod( mClass->cls, (t_method)symbolfuncs[idx], symbol, A_SYMBOL, A_NULL );
+    }
     it = inlet_new( mObject, &mObject->ob_pd, &s_symbol, symbol );
   }
-#endif
-  mInlets.push_back( Inlet::create( it, gensym("symbol"), identifier ) );
-  return mInlets.back();
+#endif
+  mInlets.push_back( Inlet::create( it, IOType::Symbol, identifier ) );
+  return InletRef( mInlets, mInlets.size() - 1 );
+}
+
+//------------------------------------------------------------------------------
+inline InletRef TRextern::addInletList( std::string identifier ) {
+  return addInletMessage( identifier, IOType::List );
+}
+
+//------------------------------------------------------------------------------
+inline InletRef TRextern::addInletAnything( std::string identifier ) {
+  return addInletMessage( identifier, IOType::Anything );
+}
+
+//------------------------------------------------------------------------------
+inline InletRef TRextern::addInletMessage( std::string identifier, IOType type ) {
+  t_inlet* it = nullptr;
+#ifdef PD
+  auto proxy   = (t_inletproxy *)pd_new( mClass->proxyclass );
+  proxy->impl  = this;
+  proxy->index = mInlets.size();
+  it = inlet_new( mObject, &proxy->pd, 0, 0 );
+  auto inlet = Inlet::create( it, type, identifier );
+  inlet.mProxy = &proxy->pd;
+  mInlets.push_back( std::move( inlet ) );
+#else
+  mInlets.push_back( Inlet::create( it, type, identifier ) );
+#endif
+  return InletRef( mInlets, mInlets.size() - 1 );
+}
+
+//------------------------------------------------------------------------------
+inline Parameter& TRextern::addParameter( std::string identifier, t_sample initial, double rampMs ) {
+  mParameters.emplace_back( new Parameter( initial, rampMs ) );
+  auto param = mParameters.back().get();
+  t_inlet* it = nullptr;
+#ifdef PD
+  auto idx = mInlets.size();
+  if ( tr_checkinletcount( mObject, idx, identifier ) ) {
+    auto symbol = gensym(("ext_parameterin_" + std::to_string(idx+1)).c_str());
+    class_addmethod( mClass->cls, (t_method)parameterfuncs[idx], symbol, A_FLOAT, A_NULL );
+    it = inlet_new( mObject, &mObject->ob_pd, &s_float, symbol );
+  }
+#endif
+  mInlets.push_back( Inlet::create( it, IOType::Float, identifier, param ) );
+  return *param;
+}
+
+//------------------------------------------------------------------------------
+inline Parameter& TRextern::addInletParameter( std::string identifier, t_sample initial, double rampMs ) {
+  if ( mMultichannel ) return addParameter( identifier, initial, rampMs );
+  mParameters.emplace_back( new Parameter( initial, rampMs ) );
+  auto param = mParameters.back().get();
+  t_inlet* it = nullptr;
+#ifdef PD
+  it = signalinlet_new( mObject, initial );
+#endif
+  mInlets.push_back( Inlet::create( it, IOType::Signal, identifier, param ) );
+  mSignalInlets.push_back( param );
+  return *param;
+}
+
+//------------------------------------------------------------------------------
+inline t_sample** TRextern::routeInputs( t_sample **ins ) {
+  auto routed = mRoutedInputs.data();
+  for ( size_t i = 0; i < mSignalInlets.size(); i++ ) {
+    if ( auto param = mSignalInlets[i] ) {
+      param->setSignal( ins[i] );
+    } else {
+      *routed++ = ins[i];
+    }
+  }
+  return mRoutedInputs.data();
+}
+
+//------------------------------------------------------------------------------
+inline bool TRextern::prepareDsp( double sampleRate, long blockSize ) {
+  releaseDsp();
+  prepareParameters( sampleRate, blockSize );
+  // Parameters follow the host's blocks, process() its own frames
+  mAdapting = mProcessBlockSize > 0 && mProcessBlockSize != blockSize && !mMultichannel;
+  auto const frameSize = mAdapting ? mProcessBlockSize : blockSize;
+  // process() runs at the oversampled rate
+  auto const factor    = isOversampling() ? mOversampling : 1;
+  if ( !mArena.prepare( sampleRate * factor, frameSize * factor ) ) return false;
+  if ( !mEvents ) {
+    mEvents.reset( new EventState );
+#ifdef PD
+    mEvents->clock = clock_new( this, (t_method)ext_eventsdue );
+#else
+    mEvents->qelem = qelem_new( this, (method)ext_eventsdue );
+#endif
+  }
+  if ( isParallel() ) {
+    if ( !m_dsppool ) m_dsppool = new DspPool( DspPool::defaultThreadCount() );
+    mParallelBuffers.prepare( mInChannels, mOutChannels, blockSize );
+    mJob.setRoutine( mClass->processjob, this );
+  }
+  mEventDelay = 0;
+  if ( mAdapting ) {
+    mFifo.prepare( mInChannels + (int)mParameters.size(), mOutChannels, frameSize, blockSize );
+    mFifoInputs.assign( mInChannels + mParameters.size(), nullptr );
+    mEventDelay += mFifo.latency();
+  }
+  if ( isOversampling() ) {
+    mOversampler.prepare( mInChannels, mOutChannels, factor, frameSize );
+    mHeldValues.assign( mParameters.size() * frameSize * factor, 0 );
+    mEventDelay += mOversampler.latency();
+  }
+  // The parallel block is left out of mEventDelay, as its messages are
+  // flushed a block late with its audio
+  mLatency = (isParallel() ? blockSize : 0) + mEventDelay;
+#ifdef TREXTERN_PROFILE
+  mProfile.prepare( sampleRate, blockSize );
+#endif
+  mSampleRate   = sampleRate * factor;
+  mMaxBlockSize = frameSize * factor;
+  prepare( mSampleRate, mMaxBlockSize );
+  mPrepared = true;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+inline void TRextern::releaseDsp() {
+  mJob.quiesce();
+  if ( !mPrepared ) return;
+  mPrepared = false;
+  release();
+}
+
+//------------------------------------------------------------------------------
+inline void TRextern::prepareParameters( double sampleRate, long blockSize ) {
+  for ( auto& param : mParameters ) {
+    param->mCopySignal = isParallel();
+    param->prepare( sampleRate, blockSize );
+  }
+  mRoutedInputs.assign( mInChannels, nullptr );
+}
+
+//------------------------------------------------------------------------------
+inline void TRextern::renderParameters( long size ) {
+  for ( auto& param : mParameters ) {
+    param->render( size );
+  }
+}
+
+//------------------------------------------------------------------------------
+//! Feeds a block through mFifo. Parameter values are buffered like the
+//  inputs, so every frame sees the values of its own samples
+template<class Process>
+void TRextern::processFrames( t_sample **ins, t_sample **outs, long size, Process&& process ) {
+  auto inputs = mFifoInputs.data();
+  std::copy( ins, ins + mInChannels, inputs );
+  for ( size_t p = 0; p < mParameters.size(); p++ ) {
+    inputs[mInChannels + p] = const_cast<t_sample *>( mParameters[p]->values() );
+  }
+  mFifo.process( inputs, outs, size, [&]( t_sample *const *frameIns, t_sample *const *frameOuts, long frameSize ) {
+    for ( size_t p = 0; p < mParameters.size(); p++ ) {
+      mParameters[p]->adopt( frameIns[mInChannels + p], frameSize );
+    }
+    process( const_cast<t_sample **>( frameIns ), const_cast<t_sample **>( frameOuts ), frameSize );
+  } );
+}
+
+//------------------------------------------------------------------------------
+//! Runs a block through mOversampler. Each parameter value is held for
+//  the samples it covers at the higher rate
+template<class Process>
+void TRextern::processOversampled( t_sample **ins, t_sample **outs, long size, Process&& process ) {
+  auto const factor = mOversampling;
+  auto const count  = size * factor;
+  auto held = mHeldValues.data();
+  for ( auto& param : mParameters ) {
+    auto values = param->values();
+    if ( param->isConstant() ) {
+      std::fill( held, held + count, values[0] );
+    } else {
+      for ( long i = 0; i < size; i++ ) std::fill( held + i * factor, held + (i + 1) * factor, values[i] );
+    }
+    param->adopt( held, count );
+    held += mMaxBlockSize;
+  }
+  mOversampler.process( ins, outs, size, [&]( t_sample *const *upIns, t_sample *const *upOuts, long upSize ) {
+    process( const_cast<t_sample **>( upIns ), const_cast<t_sample **>( upOuts ), upSize );
+  } );
+}
+
+#ifdef TREXTERN_CHECK_NUMERICS
+//------------------------------------------------------------------------------
+inline void TRextern::checkNumerics( t_sample *const *outs, int count, long size, int outlet ) {
+  // Report once per object, the audio keeps running regardless
+  if ( mNumericsReported ) return;
+  for ( auto c = 0; c < count; c++ ) {
+    long index = 0;
+    auto fault = tr_scannumeric( outs[c], size, &index );
+    if ( fault == NumericFault::None ) continue;
+    mNumericsReported = true;
+    auto name = tr_numericfaultname( fault );
+    auto where = outlet < 0 ? c : outlet;
+#ifdef PD
+    pd_error( mObject, "%s in signal outlet %d, channel %d, sample %ld", name, where, outlet < 0 ? 0 : c, index );
+#else
+    object_error( (t_object *)mObject, "%s in signal outlet %d, channel %d, sample %ld", name, where, outlet < 0 ? 0 : c, index );
+#endif
+    return;
+  }
+}
+#endif
+
+#ifdef TREXTERN_PROFILE
+//------------------------------------------------------------------------------
+inline void TRextern::countMessage( size_t inlet ) {
+  if ( inlet >= mMessageCounts.size() ) mMessageCounts.resize( inlet + 1, 0 );
+  mMessageCounts[inlet]++;
+}
+
+//------------------------------------------------------------------------------
+inline void TRextern::resetProfile() {
+  mProfile.reset();
+  mMessageCounts.assign( mMessageCounts.size(), 0 );
+}
+
+//------------------------------------------------------------------------------
+inline void TRextern::reportProfile() {
+  auto const s = mProfile.stats();
+  
+  if ( mProfileOutlet && mProfileOutlet->mOutlet ) {
+    // profile <blocks> <min> <mean> <max> <p99> <load> <overruns>
+    // messages <inlet> <count>
+    double const values[] = { double(s.blocks), s.min, s.mean, s.max, s.p99, s.load, double(s.overruns) };
+    t_atom av[7];
+    for ( auto i = 0; i < 7; i++ ) {
+#ifdef PD
+      SETFLOAT( av + i, (t_float)values[i] );
+#else
+      atom_setfloat( av + i, values[i] );
+#endif
+    }
+    outlet_anything( mProfileOutlet->mOutlet, gensym("profile"), 7, av );
+    for ( size_t i = 0; i < mMessageCounts.size(); i++ ) {
+      if ( !mMessageCounts[i] ) continue;
+#ifdef PD
+      SETFLOAT( av, (t_float)i );
+      SETFLOAT( av + 1, (t_float)mMessageCounts[i] );
+#else
+      atom_setlong( av, (t_atom_long)i );
+      atom_setlong( av + 1, (t_atom_long)mMessageCounts[i] );
+#endif
+      outlet_anything( mProfileOutlet->mOutlet, gensym("messages"), 2, av );
+    }
+    return;
+  }
+  
+#ifdef PD
+  auto const name = class_getname( mObject->ob_pd );
+  logpost( mObject, 2, "%s: %llu blocks, min %.2f mean %.2f max %.2f p99 %.2f us, load %.2f%%, %llu overruns",
+           name, (unsigned long long)s.blocks, s.min, s.mean, s.max, s.p99, s.load, (unsigned long long)s.overruns );
+  for ( size_t i = 0; i < mMessageCounts.size(); i++ ) {
+    if ( mMessageCounts[i] ) {
+      logpost( mObject, 2, "%s: inlet %d received %llu messages", name, (int)i, (unsigned long long)mMessageCounts[i] );
+    }
+  }
+#else
+  object_post( (t_object *)mObject, "%llu blocks, min %.2f mean %.2f max %.2f p99 %.2f us, load %.2f%%, %llu overruns",
+               (unsigned long long)s.blocks, s.min, s.mean, s.max, s.p99, s.load, (unsigned long long)s.overruns );
+  for ( size_t i = 0; i < mMessageCounts.size(); i++ ) {
+    if ( mMessageCounts[i] ) {
+      object_post( (t_object *)mObject, "inlet %d received %llu messages", (int)i, (unsigned long long)mMessageCounts[i] );
+    }
+  }
+#endif
+}
+
+//------------------------------------------------------------------------------
+inline void ext_profile( t_external *x, t_symbol *s ) {
+  if ( s == gensym("reset") ) {
+    x->impl->resetProfile();
+  } else {
+    x->impl->reportProfile();
+  }
 }
+#endif
 
 //------------------------------------------------------------------------------
-InletRef TRextern::addInletSignal( std::string identifier ) {
+inline InletRef TRextern::addInletSignal( std::string identifier ) {
   t_inlet* it = nullptr;
-  auto signal = gensym("signal");
 #ifdef PD
-  it = inlet_new( mObject, &mObject->ob_pd, signal, signal );
+  it = inlet_new( mObject, &mObject->ob_pd, &s_signal, &s_signal );
 #else
   // Max audio inlets are empty placeholders
   // Audio inlets are created by calling dsp_setup( mObject, inChannels );
 #endif
-  mInlets.push_back( Inlet::create( it, signal, identifier ) );
-  return mInlets.back();
+  mInlets.push_back( Inlet::create( it, IOType::Signal, identifier ) );
+  mSignalInlets.push_back( nullptr );
+  return InletRef( mInlets, mInlets.size() - 1 );
 }
 
 //! Outlets
 //------------------------------------------------------------------------------
-OutletRef TRextern::addOutlet( std::string identifier ) {
+inline OutletRef TRextern::addOutlet( std::string identifier ) {
   t_outlet* ot = nullptr;
 #ifdef PD
   ot = outlet_new( mObject, gensym( identifier.c_str()) );
 #endif
-  mOutlets.push_back( Outlet::create( ot, gensym("control"), identifier ) );
+  mOutlets.push_back( Outlet::create( ot, IOType::Control, identifier ) );
   return mOutlets.back();
 }
 
 //------------------------------------------------------------------------------
-OutletRef TRextern::addOutletSignal( std::string identifier ) {
+inline OutletRef TRextern::addOutletSignal( std::string identifier ) {
   t_outlet* ot = nullptr;
 #ifdef PD
   ot = outlet_new( mObject, &s_signal );
 #endif
-  mOutlets.push_back( Outlet::create( ot, gensym("signal"), identifier ) );
+  mOutlets.push_back( Outlet::create( ot, IOType::Signal, identifier ) );
   return mOutlets.back();
 }
 
 // Max inlet ordering is done from right to left so we need to
 // loop through and create in right order after initial setup
-void TRextern::layoutInOuts() {
+inline void TRextern::layoutInOuts() {
 #ifndef PD
   // First we set up control inlets
   for ( auto i = mInlets.size(); i-- > 0 ; ) {
-    auto it = mInlets[i];
-    if ( it->isSignal() ) {
-      it->mInlet = proxy_new( mParent, i, &mParent->m_in );
+    auto& it = mInlets[i];
+    // Signal inlets come from dsp_setup(), the leftmost inlet is the object's own
+    if ( !it.isSignal() && i > 0 ) {
+      it.mInlet = proxy_new( mParent, i, &mParent->m_in );
     }
   }
  
   // Audio inlets. Audio inlets are always placed at the far left of an object
-  dsp_setup( mObject, inChannelCount() );
+  dsp_setup( mObject, (short)mSignalInlets.size() );
+  if ( mMultichannel ) {
+    mObject->z_misc |= Z_MC_INLETS;
+  }
   
   for ( auto i = mOutlets.size(); i-- > 0 ; ) {
     auto ot = mOutlets[i];
-    ot->mOutlet = outlet_new( mParent, ot->getType()->s_name );
+    auto type = ( mMultichannel && ot->isSignal() ) ? "multichannelsignal" : ot->getType()->s_name;
+    ot->mOutlet = outlet_new( mParent, type );
   }
 #endif
 }
 
 //------------------------------------------------------------------------------
-void TRextern::cleanup() {
+inline void TRextern::cleanup() {
   post("Cleaning up");
+  if ( mDeferState ) {
+    // Pd holds its lock here, so no worker is inside tr_deferwake
+    mDeferState->alive = false;
+#ifdef PD
+    clock_free( mDeferState->clock );
+    mDeferState->clock = nullptr;
+#endif
+    mDeferState.reset();
+  }
+  if ( mEvents ) {
+#ifdef PD
+    clock_free( mEvents->clock );
+#else
+    qelem_free( mEvents->qelem );
+#endif
+    mEvents.reset();
+  }
   mInlets.clear();
   mOutlets.clear();
   exit();
 }
 
+//! Scheduled outlet messages
+//------------------------------------------------------------------------------
+inline void TRextern::scheduleBang( OutletRef const& outlet, long offset ) {
+  scheduleEvent( { outlet.get(), IOType::Bang, 0, nullptr, offset, 0 } );
+}
+
+//------------------------------------------------------------------------------
+inline void TRextern::scheduleFloat( OutletRef const& outlet, t_sample value, long offset ) {
+  scheduleEvent( { outlet.get(), IOType::Float, value, nullptr, offset, 0 } );
+}
+
+//------------------------------------------------------------------------------
+inline void TRextern::scheduleSymbol( OutletRef const& outlet, t_symbol *s, long offset ) {
+  scheduleEvent( { outlet.get(), IOType::Symbol, 0, s, offset, 0 } );
+}
+
+//------------------------------------------------------------------------------
+inline void TRextern::scheduleEvent( OutletEvent const& event ) {
+  if ( !mEvents ) return;
+  auto& events = *mEvents;
+  if ( events.count == events.block.size() ) {
+    events.overflow++;
+    return;
+  }
+  // From a sample of the frame at the oversampled rate to the host sample
+  // it is output at, counted from the start of the current block
+  auto& e = events.block[events.count++];
+  e = event;
+  e.offset = (mAdapting ? mFifo.frameStart() : 0) + event.offset / (isOversampling() ? mOversampling : 1) + mEventDelay;
+}
+
+//------------------------------------------------------------------------------
+inline void TRextern::flushEvents() {
+  if ( !mEvents ) return;
+  auto& events = *mEvents;
+  if ( events.count == 0 && events.overflow == 0 ) return;
+  uint32_t dropped = events.overflow;
+#ifdef PD
+  // Offsets are in host samples by now
+  auto const hostRate = mSampleRate / (isOversampling() ? mOversampling : 1);
+#endif
+  for ( size_t i = 0; i < events.count; i++ ) {
+    auto& e = events.block[i];
+#ifdef PD
+    e.time = clock_getsystimeafter( 1000.0 * e.offset / hostRate );
+#endif
+    if ( !events.ring.push( e ) ) dropped++;
+  }
+  events.count    = 0;
+  events.overflow = 0;
+  if ( dropped ) events.dropped.fetch_add( dropped, std::memory_order_relaxed );
+#ifdef PD
+  // Pd runs DSP on the scheduler thread, so the clock can be set directly
+  if ( !events.armed ) {
+    if ( auto next = events.ring.peek() ) {
+      clock_set( events.clock, next->time );
+      events.armed = true;
+    } else if ( dropped ) {
+      clock_delay( events.clock, 0 );
+      events.armed = true;
+    }
+  }
+#else
+  qelem_set( events.qelem );
+#endif
+}
+
+//------------------------------------------------------------------------------
+inline void TRextern::deliverEvents() {
+  if ( !mEvents ) return;
+  auto& events = *mEvents;
+  if ( auto dropped = events.dropped.exchange( 0, std::memory_order_relaxed ) ) {
+#ifdef PD
+    pd_error( mObject, "%u messages from process() dropped (see TREXTERN_EVENT_CAPACITY)", dropped );
+#else
+    object_error( (t_object *)mObject, "%u messages from process() dropped (see TREXTERN_EVENT_CAPACITY)", dropped );
+#endif
+  }
+#ifdef PD
+  events.armed = false;
+  auto const now = clock_getlogicaltime();
+#endif
+  OutletEvent event = {};
+#ifdef PD
+  while ( auto next = events.ring.peek() ) {
+    if ( next->time > now ) {
+      clock_set( events.clock, next->time );
+      events.armed = true;
+      break;
+    }
+    events.ring.pop( event );
+#else
+  while ( events.ring.pop( event ) ) {
+#endif
+    switch ( event.type ) {
+      case IOType::Bang:   event.outlet->sendBang(); break;
+      case IOType::Float:  event.outlet->sendFloat( event.value ); break;
+      case IOType::Symbol: event.outlet->sendSymbol( event.symbol ); break;
+      default: break;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+inline void ext_eventsdue( TRextern *impl ) {
+  impl->deliverEvents();
+}
+
+//! Deferred work
+//------------------------------------------------------------------------------
+inline void tr_deferdrain( DeferState *state ) {
+  if ( !state->alive ) return;
+  if ( state->job ) state->job->wait();
+  state->done.consume( []( std::unique_ptr<DeferTask>&& task ) { task->run(); } );
+}
+
+#ifdef PD
+//------------------------------------------------------------------------------
+inline void ext_deferdone( DeferState *state ) {
+  tr_deferdrain( state );
+}
+#else
+//------------------------------------------------------------------------------
+inline void ext_deferdone( std::shared_ptr<DeferState> *holder, t_symbol* /*s*/, short /*argc*/, t_atom* /*argv*/ ) {
+  std::shared_ptr<DeferState> state( std::move( *holder ) );
+  delete holder;
+  tr_deferdrain( state.get() );
+}
+#endif
+
+//------------------------------------------------------------------------------
+//! Worker side. Schedules delivery of finished results on the main thread
+inline void tr_deferwake( std::shared_ptr<DeferState> const& state ) {
+  if ( state->direct ) return;
+#ifdef PD
+  sys_lock();
+  if ( state->alive ) clock_delay( state->clock, 0 );
+  sys_unlock();
+#else
+  defer_low( new std::shared_ptr<DeferState>( state ), (method)ext_deferdone, nullptr, 0, nullptr );
+#endif
+}
+
+//! Job run by a worker: calls work and queues done with the result
+template<class Work, class Done, class Result = decltype(std::declval<Work&>()())>
+struct DeferJob {
+  std::shared_ptr<DeferState> state;
+  Work work;
+  Done done;
+  void operator()() {
+    if ( !state->alive ) return;
+    auto result = work();
+    state->done.push( tr_makedefertask( [d = std::move( done ), r = std::move( result )]() mutable {
+      d( std::move( r ) );
+    } ) );
+    tr_deferwake( state );
+  }
+};
+
+template<class Work, class Done>
+struct DeferJob<Work, Done, void> {
+  std::shared_ptr<DeferState> state;
+  Work work;
+  Done done;
+  void operator()() {
+    if ( !state->alive ) return;
+    work();
+    state->done.push( tr_makedefertask( std::move( done ) ) );
+    tr_deferwake( state );
+  }
+};
+
+//------------------------------------------------------------------------------
+template<class Work, class Done>
+void TRextern::defer( Work work, Done done ) {
+  if ( !m_workers || m_workers->threadCount() == 0 ) {
+    // No workers: run the work here and deliver the result straight away
+    auto state = std::make_shared<DeferState>();
+    state->direct = true;
+    DeferJob<Work, Done>{ state, std::move( work ), std::move( done ) }();
+    tr_deferdrain( state.get() );
+    return;
+  }
+  if ( !mDeferState ) {
+    mDeferState = std::make_shared<DeferState>();
+#ifdef PD
+    mDeferState->job = &mJob;
+    mDeferState->clock = clock_new( mDeferState.get(), (t_method)ext_deferdone );
+#endif
+  }
+  m_workers->push( tr_makedefertask( DeferJob<Work, Done>{ mDeferState, std::move( work ), std::move( done ) } ) );
+}
+
 //! Inlet
 //------------------------------------------------------------------------------
-InletRef Inlet::create( t_inlet* inlet, t_symbol* type, std::string identifier ) {
-  auto i = new Inlet;
-  i->mInlet = inlet;
-  i->mType  = type;
-  i->mId    = identifier;
-  return InletRef( i );
+inline Inlet Inlet::create( t_inlet* inlet, IOType type, std::string identifier, Parameter* parameter ) {
+  Inlet i;
+  i.mInlet     = inlet;
+  i.mType      = type;
+  i.mId        = identifier;
+  i.mParameter = parameter;
+#ifdef PD
+  i.mProxy     = nullptr;
+#endif
+  return i;
+}
+
+//------------------------------------------------------------------------------
+inline Inlet::Inlet( Inlet&& other ) noexcept
+: mInlet( other.mInlet ), mId( std::move(other.mId) ), mType( other.mType ), mParameter( other.mParameter ) {
+  other.mInlet = nullptr;
+#ifdef PD
+  mProxy = other.mProxy;
+  other.mProxy = nullptr;
+#endif
 }
 
 //------------------------------------------------------------------------------
-Inlet::~Inlet() {
-  post("Deleting inlet");
+inline Inlet::~Inlet() {
   if ( mInlet ) {
+    post("Deleting inlet");
 #ifdef PD
     inlet_free( mInlet );
 #else
     proxy_delete( mInlet );
 #endif
   }
+#ifdef PD
+  if ( mProxy ) pd_free( mProxy );
+#endif
+}
+
+//! Parameter
+//------------------------------------------------------------------------------
+inline Parameter::Parameter( t_sample initial, double rampMs )
+: mOutput( nullptr ), mSignal( nullptr ), mScalar( initial ), mConnected( false ), mCopySignal( false ),
+  mCurrent( initial ), mValue( initial ), mTarget( initial ), mStep( 0 ),
+  mMin( -1e30 ), mMax( 1e30 ), mRampMs( rampMs ),
+  mRampSamples( 0 ), mRemaining( 0 ), mConstant( false ), mBlockTime( 0 ) {}
+
+//------------------------------------------------------------------------------
+inline void Parameter::setRange( t_sample min, t_sample max ) {
+  mMin = min;
+  mMax = max;
+  mCurrent = mTarget = (mCurrent < min) ? min : (mCurrent > max) ? max : mCurrent;
+  mValue   = mCurrent;
+}
+
+//------------------------------------------------------------------------------
+inline bool Parameter::push( t_sample value ) {
+  long offset = 0;
+#ifdef PD
+  // Samples since the last block was rendered. That block ended at the
+  // current logical time, so this is the offset into the next one.
+  offset = (long)clock_gettimesincewithunits( mBlockTime, 1, 1 );
+#endif
+  value = (value < mMin) ? mMin : (value > mMax) ? mMax : value;
+#ifndef PD
+  std::lock_guard<SpinLock> guard( mPushLock );
+#endif
+  return mEvents.push( { value, offset } );
+}
+
+//------------------------------------------------------------------------------
+inline void Parameter::prepare( double sampleRate, long blockSize ) {
+  mValues.assign( blockSize, mCurrent );
+  mOutput      = mValues.data();
+  mRampSamples = (long)(mRampMs * 0.001 * sampleRate);
+  mConstant    = true;
+#ifdef PD
+  mBlockTime   = clock_getlogicaltime();
+#endif
+}
+
+//------------------------------------------------------------------------------
+inline void Parameter::setTarget( t_sample value ) {
+  mTarget = value;
+  if ( mRampSamples > 0 ) {
+    mStep      = (mTarget - mCurrent) / mRampSamples;
+    mRemaining = mRampSamples;
+  } else {
+    mCurrent   = mTarget;
+    mRemaining = 0;
+  }
+}
+
+//------------------------------------------------------------------------------
+inline void Parameter::render( long size ) {
+#ifdef PD
+  mBlockTime = clock_getlogicaltime();
+#endif
+  auto out = mValues.data();
+  mOutput = out;
+  
+  if ( mConnected && mSignal ) {
+    // Messages don't apply while a signal drives the parameter
+    Event skipped;
+    while ( mEvents.pop( skipped ) ) {}
+    if ( mCopySignal ) {
+      std::copy( mSignal, mSignal + size, out );
+    } else {
+      mOutput = mSignal;
+    }
+    mCurrent   = mTarget = mSignal[size - 1];
+    mValue     = mCurrent;
+    mRemaining = 0;
+    mConstant  = false;
+    return;
+  }
+#ifdef PD
+  // Floats sent to an unconnected signal inlet end up in Pd's scalar
+  if ( mSignal && mSignal[0] != mScalar ) {
+    mScalar = mSignal[0];
+    setTarget( (mScalar < mMin) ? mMin : (mScalar > mMax) ? mMax : mScalar );
+  }
+#endif
+  
+  // Nothing changing: only refill if the last block wasn't already flat
+  if ( !mRemaining && !mEvents.peek() ) {
+    if ( !mConstant || out[0] != mCurrent ) {
+      for ( long i = 0; i < size; i++ ) out[i] = mCurrent;
+    }
+    mValue    = mCurrent;
+    mConstant = true;
+    return;
+  }
+  
+  long i = 0;
+  while ( i < size ) {
+    // Apply events due at this sample, then run up to the next one
+    long end = size;
+    while ( auto e = mEvents.peek() ) {
+      auto offset = (e->offset < size) ? e->offset : size - 1;
+      if ( offset > i ) {
+        end = offset;
+        break;
+      }
+      setTarget( e->value );
+      Event done;
+      mEvents.pop( done );
+    }
+    for ( ; i < end; i++ ) {
+      if ( mRemaining ) {
+        mCurrent += mStep;
+        if ( --mRemaining == 0 ) mCurrent = mTarget;
+      }
+      out[i] = mCurrent;
+    }
+  }
+  mValue    = mCurrent;
+  mConstant = false;
 }
 
 //------------------------------------------------------------------------------
-bool Inlet::isSignal() const {
-  return mType == gensym("signal");
+inline void Parameter::adopt( const t_sample *values, long size ) {
+  mOutput   = values;
+  mValue    = values[size - 1];
+  mConstant = std::all_of( values, values + size, [&]( t_sample v ) { return v == mValue; } );
 }
 
 //! Outlet
 //------------------------------------------------------------------------------
-OutletRef Outlet::create( t_outlet* outlet, t_symbol* type, std::string identifier ) {
+inline OutletRef Outlet::create( t_outlet* outlet, IOType type, std::string identifier ) {
   auto i = new Outlet;
   i->mOutlet = outlet;
   i->mId     = identifier;
@@ -454,7 +2010,7 @@ OutletRef Outlet::create( t_outlet* outlet, t_symbol* type, std::string identifi
 }
 
 //------------------------------------------------------------------------------
-Outlet::~Outlet() {
+inline Outlet::~Outlet() {
   post("Deleting outlet");
 #ifdef PD
   outlet_free( mOutlet );
@@ -463,7 +2019,7 @@ Outlet::~Outlet() {
 #endif
 }
 
-const std::string Outlet::getId() const {
+inline const std::string Outlet::getId() const {
 #ifdef PD
   return std::string(outlet_getsymbol(mOutlet)->s_name);
 #else
@@ -472,17 +2028,17 @@ const std::string Outlet::getId() const {
 }
 
 //------------------------------------------------------------------------------
-void Outlet::sendBang() const {
+inline void Outlet::sendBang() const {
   outlet_bang(mOutlet);
 }
 
 //------------------------------------------------------------------------------
-void Outlet::sendFloat( t_sample f ) const {
+inline void Outlet::sendFloat( t_sample f ) const {
   outlet_float(mOutlet, f);
 }
 
 //------------------------------------------------------------------------------
-void Outlet::sendSymbol( t_symbol *s ) const {
+inline void Outlet::sendSymbol( t_symbol *s ) const {
 #ifdef PD
   outlet_symbol(mOutlet, s);
 #else
@@ -490,150 +2046,394 @@ void Outlet::sendSymbol( t_symbol *s ) const {
 #endif
 }
 
-bool Outlet::isSignal() const {
-  return mType == gensym("signal");
+//------------------------------------------------------------------------------
+inline void Outlet::sendList( AtomSpan atoms ) const {
+  auto argv = const_cast<t_atom *>( atoms.data() );
+#ifdef PD
+  outlet_list(mOutlet, &s_list, (int)atoms.size(), argv);
+#else
+  outlet_list(mOutlet, nullptr, (short)atoms.size(), argv);
+#endif
+}
+
+//------------------------------------------------------------------------------
+inline void Outlet::sendList( const t_sample *values, size_t count ) const {
+  if ( mAtoms.size() < count ) mAtoms.resize( count );
+  for ( size_t i = 0; i < count; i++ ) {
+#ifdef PD
+    SETFLOAT( &mAtoms[i], values[i] );
+#else
+    atom_setfloat( &mAtoms[i], values[i] );
+#endif
+  }
+  sendList( AtomSpan( mAtoms.data(), count ) );
+}
+
+//------------------------------------------------------------------------------
+inline void Outlet::sendAnything( t_symbol *selector, AtomSpan atoms ) const {
+  auto argv = const_cast<t_atom *>( atoms.data() );
+#ifdef PD
+  outlet_anything(mOutlet, selector, (int)atoms.size(), argv);
+#else
+  outlet_anything(mOutlet, selector, (short)atoms.size(), argv);
+#endif
 }
 
 #ifdef PD
 //! DSP routines
 //------------------------------------------------------------------------------
+inline void tr_channeltable_free( t_channeltable *table ) {
+  tr_alignedfree( table->ins );
+  table->ins      = nullptr;
+  table->outs     = nullptr;
+  table->capacity = 0;
+}
+
+//------------------------------------------------------------------------------
+inline bool tr_channeltable_resize( t_channeltable *table, int ins, int outs ) {
+  size_t const size = ins + outs;
+  if ( size > table->capacity ) {
+    tr_channeltable_free( table );
+    // Round up so the table fills whole cache lines
+    auto const bytes = (size * sizeof(t_sample *) + TREXTERN_CACHE_LINE - 1)
+                     & ~(size_t)(TREXTERN_CACHE_LINE - 1);
+    table->ins = (t_sample **)tr_alignedalloc( bytes );
+    if ( !table->ins ) return false;
+    table->capacity = bytes / sizeof(t_sample *);
+  }
+  table->outs = table->ins + ins;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+template<class D>
 t_int *ext_perform( t_int *w ) {
-  size_t vIndex = 1;
-  
-  auto impl = ((t_external *)w[vIndex++])->impl;
-  
-  auto const numIn  = impl->inChannelCount();
-  auto const numOut = impl->outChannelCount();
+  auto x = (t_external *)w[1];
+  auto n = (long)w[2];
+  tr_process<D>( x->impl, x->channels.ins, x->channels.outs, n );
+  return (w+3);
+}
+
+//------------------------------------------------------------------------------
+template<class D>
+t_int *ext_performparallel( t_int *w ) {
+  auto x = (t_external *)w[1];
+  auto n = (long)w[2];
+  tr_processparallel<D>( x->impl, x->channels.ins, x->channels.outs, n );
+  return (w+3);
+}
+
+//------------------------------------------------------------------------------
+template<class D>
+t_int *ext_performmultichannel( t_int *w ) {
+  auto impl = ((t_external *)w[1])->impl;
+  auto n = (long)w[2];
+  tr_processmultichannel<D>( impl, n );
+  return (w+3);
+}
+
+//------------------------------------------------------------------------------
+inline void ext_dspmultichannel( t_external *x, t_signal **sp ) {
+  auto impl = x->impl;
+  auto const ins  = impl->inChannelCount();
+  auto const outs = impl->outChannelCount();
+  auto const n    = sp[0]->s_n;
   
-  t_sample **const bIn = (t_sample **)alloca(numIn * sizeof(t_sample *));
-  for ( auto i = 0; i < numIn; i++ ) {
-    bIn[i] = (t_sample *)w[i+vIndex];
-    vIndex++;
+#ifdef TREXTERN_PD_MULTICHANNEL
+  for ( auto i = 0; i < ins; i++ ) {
+    impl->setInputChannels( i, sp[i]->s_nchans );
   }
+#endif
+  impl->layoutBuses( n );
   
-  t_sample **const bOut = (t_sample **)alloca(numOut * sizeof(t_sample *));
-  for ( auto i = 0; i < numOut; i++ ) {
-    bOut[i] = (t_sample *)w[i+vIndex];
-    vIndex++;
+  // Pd stores the channels of a connection one after the other
+  auto assign = []( SignalBus& bus, t_signal *sig, long n ) {
+    auto channels = const_cast<t_sample**>( bus.channels );
+    bus.data = sig->s_vec;
+    for ( auto c = 0; c < bus.channelCount; c++ ) {
+      channels[c] = sig->s_vec + c * n;
+    }
+  };
+  for ( auto i = 0; i < ins; i++ ) {
+    assign( impl->inputBuses()[i], sp[i], n );
+  }
+  for ( auto i = 0; i < outs; i++ ) {
+    auto& bus = impl->outputBuses()[i];
+#ifdef TREXTERN_PD_MULTICHANNEL
+    signal_setmultiout( &sp[ins + i], bus.channelCount );
+#endif
+    assign( bus, sp[ins + i], n );
   }
   
-  impl->process( bIn, bOut, (long)w[vIndex++] /*n*/ );
-  
-  return (w+vIndex);
+  dsp_add( impl->mClass->performmultichannel, 2, x, (t_int)n );
 }
 
-// #define USE_DEBUG
-
 //------------------------------------------------------------------------------
-void ext_dsp( t_external *x, t_signal **sp ) {
+inline void ext_dsp( t_external *x, t_signal **sp ) {
   auto impl = x->impl;
-#ifndef USE_DEBUG
   auto const ins  = impl->inChannelCount();
   auto const outs = impl->outChannelCount();
-  auto const numChannels = ins + outs;
+  auto const signalIns = (int)impl->signalInlets().size();
   
-  // + 2 for x and sp[0]->s_n (class ptr and vector size)
-  auto const vSize = numChannels + 2;
+  if ( signalIns + outs == 0 ) return;
   
-  // Add properties to vector.
-  // First element is pointer to class
-  t_int v[vSize];
-  v[0] = (t_int)x;
+  if ( !impl->prepareDsp( sp[0]->s_sr, sp[0]->s_n ) ) {
+    pd_error( x, "Failed to allocate DSP buffers" );
+    return;
+  }
   
-  // Inlets
-  auto vIndex = 1;
-  for ( auto i = 0; i < ins; i++ ) {
-    v[vIndex] = (t_int)sp[i]->s_vec;
-    vIndex++;
+  if ( impl->isMultichannel() ) {
+    ext_dspmultichannel( x, sp );
+    return;
   }
   
-  // Signal vector is ordered according to graphical representation of
-  // object so first audio outlet will come after all audio inlets
-  for ( auto i = ins; i < numChannels; i++ ) {
-    v[vIndex] = (t_int)sp[i]->s_vec;
-    vIndex++;
+  if ( !tr_channeltable_resize( &x->channels, ins, outs ) ) {
+    pd_error( x, "Failed to allocate channel table" );
+    return;
   }
   
-  // Add vector size last. All signal vectors of a patch are same size
-  v[vIndex] = (t_int)sp[0]->s_n;
+#ifdef TREXTERN_PD_MULTICHANNEL
+  // Multichannel classes allocate their own outputs
+  for ( auto i = signalIns; i < signalIns + outs; i++ ) {
+    signal_setmultiout( &sp[i], 1 );
+  }
+#endif
   
-  dsp_addv(ext_perform, vSize, v);
+  // Signal vector is ordered according to graphical representation of
+  // object so first audio outlet will come after all signal inlets.
+  // Parameter inlets read their signal directly
+  auto in = x->channels.ins;
+  for ( auto i = 0; i < signalIns; i++ ) {
+    if ( auto param = impl->signalInlets()[i] ) {
+#ifdef TREXTERN_PD_MULTICHANNEL
+      // Pd 0.54 marks unconnected inlets, older versions always pass a signal
+      param->connect( !sp[i]->s_isscalar );
 #else
-  dsp_add(ext_perform, 5, x,
-          sp[0]->s_vec, sp[1]->s_vec, sp[2]->s_vec, sp[0]->s_n);
+      param->connect( true );
 #endif
+      param->setSignal( sp[i]->s_vec );
+    } else {
+      *in++ = sp[i]->s_vec;
+    }
+  }
+  for ( auto i = 0; i < outs; i++ ) {
+    x->channels.outs[i] = sp[signalIns + i]->s_vec;
+  }
+  
+  // All signal vectors of a patch are same size
+  auto const cls = impl->mClass;
+  dsp_add( impl->isParallel() ? cls->performparallel : cls->perform, 2, x, (t_int)sp[0]->s_n );
 }
 
 #else // Max
 
 //------------------------------------------------------------------------------
+template<class D>
 void ext_perform64(t_external *x, t_object *dsp64, t_sample **ins, long numins, t_sample **outs, long numouts, long sampleframes, long flags, void *userparam)
 {
-  x->impl->process( ins, outs, sampleframes );
+  auto impl = x->impl;
+  if ( impl->hasSignalParameters() ) ins = impl->routeInputs( ins );
+  tr_process<D>( impl, ins, outs, sampleframes );
+}
+
+//------------------------------------------------------------------------------
+template<class D>
+void ext_perform64parallel(t_external *x, t_object *dsp64, t_sample **ins, long numins, t_sample **outs, long numouts, long sampleframes, long flags, void *userparam)
+{
+  auto impl = x->impl;
+  if ( impl->hasSignalParameters() ) ins = impl->routeInputs( ins );
+  tr_processparallel<D>( impl, ins, outs, sampleframes );
+}
+
+//------------------------------------------------------------------------------
+template<class D>
+void ext_perform64multichannel(t_external *x, t_object *dsp64, t_sample **ins, long numins, t_sample **outs, long numouts, long sampleframes, long flags, void *userparam)
+{
+  auto impl = x->impl;
+  // Max passes every channel of every inlet in one flat list
+  auto channels = impl->busChannels();
+  for ( long i = 0; i < numins; i++ )  *channels++ = ins[i];
+  for ( long i = 0; i < numouts; i++ ) *channels++ = outs[i];
+  
+  tr_processmultichannel<D>( impl, sampleframes );
 }
 
 //------------------------------------------------------------------------------
+template<class D>
 void ext_dsp64(t_external *x, t_object *dsp64, short *count, t_sample samplerate, long maxvectorsize, long flags)
 {
-  object_method(dsp64, gensym("dsp_add64"), x, ext_perform64, 0, NULL);
+  auto impl = x->impl;
+  if ( !impl->prepareDsp( samplerate, maxvectorsize ) ) {
+    object_error( (t_object *)x, "Failed to allocate DSP buffers" );
+    return;
+  }
+  // Parameters follow their signal only while it is connected
+  for ( size_t i = 0; i < impl->signalInlets().size(); i++ ) {
+    if ( auto param = impl->signalInlets()[i] ) param->connect( count[i] != 0 );
+  }
+  if ( impl->isMultichannel() ) {
+    for ( auto i = 0; i < impl->inChannelCount(); i++ ) {
+      auto channels = (long)object_method(dsp64, gensym("getnuminputchannels"), x, i);
+      impl->setInputChannels( i, (int)channels );
+    }
+    impl->layoutBuses( maxvectorsize );
+    object_method(dsp64, gensym("dsp_add64"), x, ext_perform64multichannel<D>, 0, NULL);
+  } else if ( impl->isParallel() ) {
+    object_method(dsp64, gensym("dsp_add64"), x, ext_perform64parallel<D>, 0, NULL);
+  } else {
+    object_method(dsp64, gensym("dsp_add64"), x, ext_perform64<D>, 0, NULL);
+  }
+}
+
+//------------------------------------------------------------------------------
+inline long ext_multichanneloutputs( t_external *x, long index )
+{
+  auto impl = x->impl;
+  if ( !impl->isMultichannel() ) return 1;
+  // Signal outlets come first
+  if ( index >= impl->outChannelCount() ) return 0;
+  impl->layoutBuses( 0 );
+  return impl->outputBuses()[index].channelCount;
+}
+
+//------------------------------------------------------------------------------
+inline long ext_inputchanged( t_external *x, long index, long count )
+{
+  auto impl = x->impl;
+  if ( !impl->isMultichannel() ) return false;
+  impl->setInputChannels( (int)index, (int)count );
+  return true;
 }
 
 #endif
 
 //------------------------------------------------------------------------------
-t_external *ext_alloc() {
+inline t_external *ext_alloc( t_class *cls ) {
 #ifdef PD
-  return (t_external *)pd_new(m_class);
+  return (t_external *)pd_new(cls);
 #else
-  return (t_external *)object_alloc(m_class);
+  return (t_external *)object_alloc(cls);
 #endif
 }
 
 //------------------------------------------------------------------------------
-void ext_free( t_external *x ) {
-#ifndef PD
+template<class CLASS>
+void *ext_new( t_symbol* /*s*/, int argc, t_atom *argv ) {
+  auto& cls = tr_externclass<CLASS>();
+  t_external *x = ext_alloc( cls.cls );
+  x->impl = new CLASS;
+  x->impl->mObject = &x->x_obj;
+  x->impl->mParent = x;
+  x->impl->mClass  = &cls;
+  x->impl->setup(argc, argv);
+  x->impl->layoutInOuts();
+  return (x);
+}
+
+//------------------------------------------------------------------------------
+inline void ext_free( t_external *x ) {
+#ifdef PD
+  tr_channeltable_free( &x->channels );
+#else
   dsp_free((t_pxobject *)x);
 #endif
+  // While the object is still whole, so its release() override runs
+  x->impl->releaseDsp();
   delete x->impl;
 }
 
 //------------------------------------------------------------------------------
+inline void tr_resolvesymbols() {
+  m_iosymbols[(int)IOType::Bang]    = gensym("bang");
+  m_iosymbols[(int)IOType::Int]     = gensym("int");
+  m_iosymbols[(int)IOType::Float]   = gensym("float");
+  m_iosymbols[(int)IOType::Symbol]  = gensym("symbol");
+  m_iosymbols[(int)IOType::List]     = gensym("list");
+  m_iosymbols[(int)IOType::Anything] = gensym("anything");
+  m_iosymbols[(int)IOType::Signal]  = gensym("signal");
+  m_iosymbols[(int)IOType::Control] = gensym("control");
+}
+
+//------------------------------------------------------------------------------
+template<class CLASS>
 void tr_initialise (std::string title )
 {
+  using D = DispatchFor<CLASS>;
+  // A subclass of a static class would have its overrides skipped
+  static_assert( std::is_same<D, VirtualDispatch>::value || std::is_same<D, StaticDispatch<CLASS>>::value,
+                 "Derive from TRexternStatic<CLASS> to use static dispatch with CLASS" );
+  auto& cls = tr_externclass<CLASS>();
+  // A library and the class's own setup function may both register it
+  if ( cls.cls ) return;
+  tr_resolvesymbols();
+  if ( !m_workers ) m_workers = new WorkerPool( TREXTERN_WORKER_THREADS );
+  cls.processjob = tr_processjob<D>;
 #ifdef PD
-    m_class = class_new (gensym (title.c_str()),
-                         (t_newmethod)ext_new,
+    cls.cls = class_new (gensym (title.c_str()),
+                         (t_newmethod)ext_new<CLASS>,
                          (t_method)ext_free,
                          sizeof (t_external),
+#ifdef TREXTERN_PD_MULTICHANNEL
+                         CLASS_NOINLET | CLASS_MULTICHANNEL,
+#else
                          CLASS_NOINLET,
+#endif
                          A_GIMME,
                          A_NULL);
+    cls.perform = ext_perform<D>;
+    cls.performmultichannel = ext_performmultichannel<D>;
+    cls.performparallel = ext_performparallel<D>;
+    cls.bangfuncs   = D::hasBang   ? Trampolines<D>::bang.data()   : nullptr;
+    cls.floatfuncs  = D::hasFloat  ? Trampolines<D>::floatv.data() : nullptr;
+    cls.symbolfuncs = D::hasSymbol ? Trampolines<D>::symbol.data() : nullptr;
+    cls.proxyclass = class_new( gensym( (title + " inlet").c_str() ), 0, 0,
+                                sizeof (t_inletproxy), CLASS_PD, A_NULL );
+    class_addlist( cls.proxyclass, (t_method)ext_proxylist<D> );
+    class_addanything( cls.proxyclass, (t_method)ext_proxyanything<D> );
+#ifdef TREXTERN_PROFILE
+    class_addmethod( cls.cls, (t_method)ext_profile, gensym("profile"), A_DEFSYM, A_NULL );
+#endif
 #else
-  m_class = class_new (title,
-                       (method)ext_new,
-                       (method)ext_free,
-                       sizeof (t_external),
-                       0L,
-                       A_GIMME,
-                       0);
-  class_addmethod(m_class, (method)ext_bangin,  "bang", 0);
-  class_addmethod(m_class, (method)ext_floatin, "float",  A_FLOAT, 0);
-  class_addmethod(m_class, (method)ext_intin,   "int",    A_LONG, 0);
-  class_addmethod(m_class, (method)ext_symbolin,"symbol", A_SYM, 0);
-  //  class_addmethod(m_class, (method)ext_list,     "list", A_GIMME, 0);
-  //  class_addmethod(m_class, (method)ext_anything, "anything", A_GIMME, 0);
+  auto c = class_new (title.c_str(),
+                      (method)ext_new<CLASS>,
+                      (method)ext_free,
+                      sizeof (t_external),
+                      0L,
+                      A_GIMME,
+                      0);
+  cls.cls = c;
+  // List and anything inlets also take bangs, ints and symbols
+  constexpr bool messages = D::hasList || D::hasAnything;
+  if ( D::hasBang || messages )   class_addmethod(c, (method)ext_bangin<D>,  "bang", 0);
+  // Float is always registered since parameter inlets depend on it
+  class_addmethod(c, (method)ext_floatin<D>, "float",  A_FLOAT, 0);
+  if ( D::hasInt || messages )    class_addmethod(c, (method)ext_intin<D>,   "int",    A_LONG, 0);
+  if ( D::hasSymbol || messages ) class_addmethod(c, (method)ext_symbolin<D>,"symbol", A_SYM, 0);
+  if ( messages ) {
+    class_addmethod(c, (method)ext_listin<D>,     "list",     A_GIMME, 0);
+    class_addmethod(c, (method)ext_anythingin<D>, "anything", A_GIMME, 0);
+  }
 #warning TODO MAX
   // TODO: Support for non DSP objects
   // If dsp
-  class_addmethod(m_class, (method)ext_dsp64, "dsp64",  A_CANT, 0);
-  class_dspinit(m_class);
+  if ( D::hasProcess || D::hasProcessMultichannel ) {
+    class_addmethod(c, (method)ext_dsp64<D>, "dsp64",  A_CANT, 0);
+  }
+  if ( D::hasProcessMultichannel ) {
+    class_addmethod(c, (method)ext_multichanneloutputs, "multichanneloutputs", A_CANT, 0);
+    class_addmethod(c, (method)ext_inputchanged,        "inputchanged",        A_CANT, 0);
+  }
+#ifdef TREXTERN_PROFILE
+  class_addmethod(c, (method)ext_profile, "profile", A_DEFSYM, 0);
+#endif
+  class_dspinit(c);
   // endif
-  class_register(CLASS_BOX, m_class);
+  class_register(CLASS_BOX, c);
 #endif
 }
 
 // Replaces occurences of '_tilde' with ~
-std::string tr_tildefy (std::string title)
+inline std::string tr_tildefy (std::string title)
 {
     static std::string tilde ("_tilde");
     
@@ -643,25 +2443,59 @@ std::string tr_tildefy (std::string title)
     return title;
 }
 
+//! Setup functions of every class compiled into the binary. Each
+//  TREXTERN_CREATE adds its class when the binary is loaded
+inline std::vector<void (*)(void)>& tr_registry() {
+  static std::vector<void (*)(void)> setups;
+  return setups;
+}
+
+struct ExternRegistrar {
+  ExternRegistrar( void (*setup)(void) ) { tr_registry().push_back( setup ); }
+};
+
+//------------------------------------------------------------------------------
+inline void tr_setuplibrary() {
+  for ( auto setup : tr_registry() ) setup();
+}
+
 #define PD_SETUP(NAME) NAME ## _setup
 
+//! Max calls ext_main of the bundle. Weak, so a library's own ext_main
+//  takes over when several classes are linked together
+#ifdef PD
+#define TREXTERN_MAIN( SETUP )
+#else
+#define TREXTERN_MAIN( SETUP ) \
+__attribute__((weak)) void ext_main(void* /*r*/) { \
+  SETUP(); \
+}
+#endif
+
+//! Defines the setup function of CLASS and adds it to the binary's registry
 #define TREXTERN_CREATE( CLASS ) \
 \
-void *ext_new( t_symbol* /*s*/, int argc, t_atom *argv ) { \
-  t_external *x = ext_alloc(); \
-  x->impl = new CLASS; \
-  x->impl->mObject = &x->x_obj; \
-  x->impl->mParent = x; \
-  x->impl->setup(argc, argv); \
-  x->impl->layoutInOuts(); \
-  return (x); \
-} \
-\
 extern "C" __attribute__((visibility("default"))) \
 void PD_SETUP(CLASS)(void) { \
-  tr_initialise(tr_tildefy(#CLASS)); \
+  tr_initialise<CLASS>(tr_tildefy(#CLASS)); \
 } \
 \
+static ExternRegistrar tr_registrar_ ## CLASS( PD_SETUP(CLASS) ); \
+TREXTERN_MAIN( PD_SETUP(CLASS) )
+
+//! Defines the setup function of a library of classes, each in its own
+//  file with its own TREXTERN_CREATE. Pd loads it with [declare -lib NAME]
+//  and calls NAME_setup, which registers every class in the binary. NAME
+//  must differ from the class names
+#ifdef PD
+#define TREXTERN_LIBRARY( NAME ) \
+extern "C" __attribute__((visibility("default"))) \
+void PD_SETUP(NAME)(void) { \
+  tr_setuplibrary(); \
+}
+#else
+#define TREXTERN_LIBRARY( NAME ) \
 void ext_main(void* /*r*/) { \
-  tr_initialise(tr_tildefy(#CLASS)); \
-} \
+  tr_setuplibrary(); \
+}
+#endif
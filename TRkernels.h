@@ -0,0 +1,276 @@
+//
+//  TRkernels.h
+//  TRextern
+//
+//  Copyright © 2026 Reactify. All rights reserved.
+//
+
+// Vectorised block kernels for process() implementations. Works with both
+// float (Pd) and double (Max) samples:
+//
+//   tr_crossfade( out, in1, in2, balance, size );
+//
+// The instruction set is picked at compile time: AVX2 when building with
+// -mavx2, NEON on ARM, otherwise SSE2 on x86 with a runtime switch to AVX2
+// on CPUs that support it. Anything else falls back to scalar loops.
+
+#pragma once
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#define TR_KERNELS_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define TR_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+#define TR_KERNEL_INLINE inline __attribute__((always_inline))
+
+//! Scalar fallback
+template<class Sample>
+struct ScalarOps {
+  using T = Sample;
+  using V = Sample;
+  static constexpr long width = 1;
+  static TR_KERNEL_INLINE V load ( const T *p )      { return *p; }
+  static TR_KERNEL_INLINE void store( T *p, V v )    { *p = v; }
+  static TR_KERNEL_INLINE V set1 ( T v )             { return v; }
+  static TR_KERNEL_INLINE V add  ( V a, V b )        { return a + b; }
+  static TR_KERNEL_INLINE V sub  ( V a, V b )        { return a - b; }
+  static TR_KERNEL_INLINE V mul  ( V a, V b )        { return a * b; }
+  static TR_KERNEL_INLINE V min  ( V a, V b )        { return a < b ? a : b; }
+  static TR_KERNEL_INLINE V max  ( V a, V b )        { return a > b ? a : b; }
+};
+
+#if TR_KERNELS_X86
+template<class Sample> struct SseOps;
+
+template<>
+struct SseOps<float> {
+  using T = float;
+  using V = __m128;
+  static constexpr long width = 4;
+  static TR_KERNEL_INLINE V load ( const T *p )      { return _mm_loadu_ps( p ); }
+  static TR_KERNEL_INLINE void store( T *p, V v )    { _mm_storeu_ps( p, v ); }
+  static TR_KERNEL_INLINE V set1 ( T v )             { return _mm_set1_ps( v ); }
+  static TR_KERNEL_INLINE V add  ( V a, V b )        { return _mm_add_ps( a, b ); }
+  static TR_KERNEL_INLINE V sub  ( V a, V b )        { return _mm_sub_ps( a, b ); }
+  static TR_KERNEL_INLINE V mul  ( V a, V b )        { return _mm_mul_ps( a, b ); }
+  static TR_KERNEL_INLINE V min  ( V a, V b )        { return _mm_min_ps( a, b ); }
+  static TR_KERNEL_INLINE V max  ( V a, V b )        { return _mm_max_ps( a, b ); }
+};
+
+template<>
+struct SseOps<double> {
+  using T = double;
+  using V = __m128d;
+  static constexpr long width = 2;
+  static TR_KERNEL_INLINE V load ( const T *p )      { return _mm_loadu_pd( p ); }
+  static TR_KERNEL_INLINE void store( T *p, V v )    { _mm_storeu_pd( p, v ); }
+  static TR_KERNEL_INLINE V set1 ( T v )             { return _mm_set1_pd( v ); }
+  static TR_KERNEL_INLINE V add  ( V a, V b )        { return _mm_add_pd( a, b ); }
+  static TR_KERNEL_INLINE V sub  ( V a, V b )        { return _mm_sub_pd( a, b ); }
+  static TR_KERNEL_INLINE V mul  ( V a, V b )        { return _mm_mul_pd( a, b ); }
+  static TR_KERNEL_INLINE V min  ( V a, V b )        { return _mm_min_pd( a, b ); }
+  static TR_KERNEL_INLINE V max  ( V a, V b )        { return _mm_max_pd( a, b ); }
+};
+#endif
+
+#if TR_KERNELS_NEON
+template<class Sample> struct NeonOps;
+
+template<>
+struct NeonOps<float> {
+  using T = float;
+  using V = float32x4_t;
+  static constexpr long width = 4;
+  static TR_KERNEL_INLINE V load ( const T *p )      { return vld1q_f32( p ); }
+  static TR_KERNEL_INLINE void store( T *p, V v )    { vst1q_f32( p, v ); }
+  static TR_KERNEL_INLINE V set1 ( T v )             { return vdupq_n_f32( v ); }
+  static TR_KERNEL_INLINE V add  ( V a, V b )        { return vaddq_f32( a, b ); }
+  static TR_KERNEL_INLINE V sub  ( V a, V b )        { return vsubq_f32( a, b ); }
+  static TR_KERNEL_INLINE V mul  ( V a, V b )        { return vmulq_f32( a, b ); }
+  static TR_KERNEL_INLINE V min  ( V a, V b )        { return vminq_f32( a, b ); }
+  static TR_KERNEL_INLINE V max  ( V a, V b )        { return vmaxq_f32( a, b ); }
+};
+
+#if defined(__aarch64__)
+template<>
+struct NeonOps<double> {
+  using T = double;
+  using V = float64x2_t;
+  static constexpr long width = 2;
+  static TR_KERNEL_INLINE V load ( const T *p )      { return vld1q_f64( p ); }
+  static TR_KERNEL_INLINE void store( T *p, V v )    { vst1q_f64( p, v ); }
+  static TR_KERNEL_INLINE V set1 ( T v )             { return vdupq_n_f64( v ); }
+  static TR_KERNEL_INLINE V add  ( V a, V b )        { return vaddq_f64( a, b ); }
+  static TR_KERNEL_INLINE V sub  ( V a, V b )        { return vsubq_f64( a, b ); }
+  static TR_KERNEL_INLINE V mul  ( V a, V b )        { return vmulq_f64( a, b ); }
+  static TR_KERNEL_INLINE V min  ( V a, V b )        { return vminq_f64( a, b ); }
+  static TR_KERNEL_INLINE V max  ( V a, V b )        { return vmaxq_f64( a, b ); }
+};
+#else
+// 32-bit ARM has no double vectors
+template<> struct NeonOps<double> : ScalarOps<double> {};
+#endif
+#endif
+
+// Kernels for the baseline instruction set
+#define TR_KERNELSET KernelSet
+#include "TRkernels_impl.h"
+#undef TR_KERNELSET
+
+// AVX2 kernels. When the whole build targets AVX2 they are the baseline,
+// otherwise they're compiled separately and picked at runtime.
+#if TR_KERNELS_X86
+#if !defined(__AVX2__)
+#define TR_KERNELS_DISPATCH 1
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+#endif
+
+template<class Sample> struct Avx2Ops;
+
+template<>
+struct Avx2Ops<float> {
+  using T = float;
+  using V = __m256;
+  static constexpr long width = 8;
+  static TR_KERNEL_INLINE V load ( const T *p )      { return _mm256_loadu_ps( p ); }
+  static TR_KERNEL_INLINE void store( T *p, V v )    { _mm256_storeu_ps( p, v ); }
+  static TR_KERNEL_INLINE V set1 ( T v )             { return _mm256_set1_ps( v ); }
+  static TR_KERNEL_INLINE V add  ( V a, V b )        { return _mm256_add_ps( a, b ); }
+  static TR_KERNEL_INLINE V sub  ( V a, V b )        { return _mm256_sub_ps( a, b ); }
+  static TR_KERNEL_INLINE V mul  ( V a, V b )        { return _mm256_mul_ps( a, b ); }
+  static TR_KERNEL_INLINE V min  ( V a, V b )        { return _mm256_min_ps( a, b ); }
+  static TR_KERNEL_INLINE V max  ( V a, V b )        { return _mm256_max_ps( a, b ); }
+};
+
+template<>
+struct Avx2Ops<double> {
+  using T = double;
+  using V = __m256d;
+  static constexpr long width = 4;
+  static TR_KERNEL_INLINE V load ( const T *p )      { return _mm256_loadu_pd( p ); }
+  static TR_KERNEL_INLINE void store( T *p, V v )    { _mm256_storeu_pd( p, v ); }
+  static TR_KERNEL_INLINE V set1 ( T v )             { return _mm256_set1_pd( v ); }
+  static TR_KERNEL_INLINE V add  ( V a, V b )        { return _mm256_add_pd( a, b ); }
+  static TR_KERNEL_INLINE V sub  ( V a, V b )        { return _mm256_sub_pd( a, b ); }
+  static TR_KERNEL_INLINE V mul  ( V a, V b )        { return _mm256_mul_pd( a, b ); }
+  static TR_KERNEL_INLINE V min  ( V a, V b )        { return _mm256_min_pd( a, b ); }
+  static TR_KERNEL_INLINE V max  ( V a, V b )        { return _mm256_max_pd( a, b ); }
+};
+
+#define TR_KERNELSET KernelSetAvx2
+#include "TRkernels_impl.h"
+#undef TR_KERNELSET
+
+#if TR_KERNELS_DISPATCH
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+#endif
+#endif
+
+//! Baseline kernels for a sample type
+#if TR_KERNELS_X86 && !TR_KERNELS_DISPATCH
+template<class T> using BaseKernels = KernelSetAvx2<Avx2Ops<T>>;
+#elif TR_KERNELS_X86
+template<class T> using BaseKernels = KernelSet<SseOps<T>>;
+#elif TR_KERNELS_NEON
+template<class T> using BaseKernels = KernelSet<NeonOps<T>>;
+#else
+template<class T> using BaseKernels = KernelSet<ScalarOps<T>>;
+#endif
+
+#if TR_KERNELS_DISPATCH
+//! Kernel entry points picked once at runtime
+template<class T>
+struct KernelTable {
+  void (*gain)      ( T *, const T *, T, long );
+  void (*crossfade) ( T *, const T *, const T *, T, long );
+  void (*crossfadev)( T *, const T *, const T *, const T *, long );
+  void (*add)       ( T *, const T *, const T *, long );
+  void (*multiply)  ( T *, const T *, const T *, long );
+  void (*clamp)     ( T *, const T *, T, T, long );
+  void (*ramp)      ( T *, T, T, long );
+  void (*copy)      ( T *, const T *, long );
+  void (*clear)     ( T *, long );
+  void (*fir)       ( T *, const T *, const T *, long, long );
+};
+
+template<class K, class T>
+KernelTable<T> tr_makekerneltable() {
+  return { K::gain, K::crossfade, K::crossfadev, K::add, K::multiply,
+           K::clamp, K::ramp, K::copy, K::clear, K::fir };
+}
+
+template<class T>
+const KernelTable<T>& tr_kernels() {
+  static const KernelTable<T> table = __builtin_cpu_supports("avx2")
+    ? tr_makekerneltable<KernelSetAvx2<Avx2Ops<T>>, T>()
+    : tr_makekerneltable<BaseKernels<T>, T>();
+  return table;
+}
+#define TR_KERNEL_CALL(T, NAME) tr_kernels<T>().NAME
+#else
+#define TR_KERNEL_CALL(T, NAME) BaseKernels<T>::NAME
+#endif
+
+//! out = in * gain
+template<class T> inline void tr_gain( T *out, const T *in, T gain, long n ) {
+  TR_KERNEL_CALL(T, gain)( out, in, gain, n );
+}
+
+//! out = a * (1 - mix) + b * mix
+template<class T> inline void tr_crossfade( T *out, const T *a, const T *b, T mix, long n ) {
+  TR_KERNEL_CALL(T, crossfade)( out, a, b, mix, n );
+}
+
+//! Crossfade with a mix value per sample
+template<class T> inline void tr_crossfade( T *out, const T *a, const T *b, const T *mix, long n ) {
+  TR_KERNEL_CALL(T, crossfadev)( out, a, b, mix, n );
+}
+
+//! out = a + b
+template<class T> inline void tr_add( T *out, const T *a, const T *b, long n ) {
+  TR_KERNEL_CALL(T, add)( out, a, b, n );
+}
+
+//! out = a * b
+template<class T> inline void tr_multiply( T *out, const T *a, const T *b, long n ) {
+  TR_KERNEL_CALL(T, multiply)( out, a, b, n );
+}
+
+//! out = in limited to [lo, hi]
+template<class T> inline void tr_clamp( T *out, const T *in, T lo, T hi, long n ) {
+  TR_KERNEL_CALL(T, clamp)( out, in, lo, hi, n );
+}
+
+//! out[i] = start + i * step
+template<class T> inline void tr_ramp( T *out, T start, T step, long n ) {
+  TR_KERNEL_CALL(T, ramp)( out, start, step, n );
+}
+
+//! out = in
+template<class T> inline void tr_copy( T *out, const T *in, long n ) {
+  TR_KERNEL_CALL(T, copy)( out, in, n );
+}
+
+//! out = 0
+template<class T> inline void tr_clear( T *out, long n ) {
+  TR_KERNEL_CALL(T, clear)( out, n );
+}
+
+//! Symmetric FIR folded in half: out[i] = sum over k < taps of
+//  coeffs[k] * (in[i + k] + in[i + 2 * taps - 1 - k]). in starts with
+//  2 * taps - 1 samples of history
+template<class T> inline void tr_fir( T *out, const T *in, const T *coeffs, long taps, long n ) {
+  TR_KERNEL_CALL(T, fir)( out, in, coeffs, taps, n );
+}
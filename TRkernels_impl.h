@@ -0,0 +1,135 @@
+//
+//  TRkernels_impl.h
+//  TRextern
+//
+//  Copyright © 2026 Reactify. All rights reserved.
+//
+
+// Kernel bodies shared by every instruction set. Included by TRkernels.h,
+// once per target, with TR_KERNELSET naming the generated template.
+// Do not include directly.
+
+#ifndef TR_KERNELSET
+#error "TRkernels_impl.h is included by TRkernels.h only"
+#endif
+
+//! Block kernels written against an Ops vector abstraction. Every loop
+//  runs full vectors first and finishes the remainder with scalar code.
+//  Output may alias any input at the same position.
+template<class Ops>
+struct TR_KERNELSET {
+  using T = typename Ops::T;
+  using V = typename Ops::V;
+  static constexpr long W = Ops::width;
+
+  //! out = in * gain
+  static void gain( T *out, const T *in, T gain, long n ) {
+    long i = 0;
+    long const vn = n - n % W;
+    V const g = Ops::set1( gain );
+    for ( ; i < vn; i += W ) Ops::store( out + i, Ops::mul( Ops::load( in + i ), g ) );
+    for ( ; i < n; i++ ) out[i] = in[i] * gain;
+  }
+
+  //! out = a * (1 - mix) + b * mix
+  static void crossfade( T *out, const T *a, const T *b, T mix, long n ) {
+    long i = 0;
+    long const vn = n - n % W;
+    V const m  = Ops::set1( mix );
+    V const im = Ops::set1( T(1) - mix );
+    for ( ; i < vn; i += W ) {
+      Ops::store( out + i, Ops::add( Ops::mul( Ops::load( a + i ), im ),
+                                     Ops::mul( Ops::load( b + i ), m ) ) );
+    }
+    for ( ; i < n; i++ ) out[i] = a[i] * (T(1) - mix) + b[i] * mix;
+  }
+
+  //! out = a * (1 - mix) + b * mix, with a mix value per sample
+  static void crossfadev( T *out, const T *a, const T *b, const T *mix, long n ) {
+    long i = 0;
+    long const vn = n - n % W;
+    V const one = Ops::set1( T(1) );
+    for ( ; i < vn; i += W ) {
+      V const m = Ops::load( mix + i );
+      Ops::store( out + i, Ops::add( Ops::mul( Ops::load( a + i ), Ops::sub( one, m ) ),
+                                     Ops::mul( Ops::load( b + i ), m ) ) );
+    }
+    for ( ; i < n; i++ ) out[i] = a[i] * (T(1) - mix[i]) + b[i] * mix[i];
+  }
+
+  //! out = a + b
+  static void add( T *out, const T *a, const T *b, long n ) {
+    long i = 0;
+    long const vn = n - n % W;
+    for ( ; i < vn; i += W ) Ops::store( out + i, Ops::add( Ops::load( a + i ), Ops::load( b + i ) ) );
+    for ( ; i < n; i++ ) out[i] = a[i] + b[i];
+  }
+
+  //! out = a * b
+  static void multiply( T *out, const T *a, const T *b, long n ) {
+    long i = 0;
+    long const vn = n - n % W;
+    for ( ; i < vn; i += W ) Ops::store( out + i, Ops::mul( Ops::load( a + i ), Ops::load( b + i ) ) );
+    for ( ; i < n; i++ ) out[i] = a[i] * b[i];
+  }
+
+  //! out = min(max(in, lo), hi)
+  static void clamp( T *out, const T *in, T lo, T hi, long n ) {
+    long i = 0;
+    long const vn = n - n % W;
+    V const l = Ops::set1( lo );
+    V const h = Ops::set1( hi );
+    for ( ; i < vn; i += W ) Ops::store( out + i, Ops::min( Ops::max( Ops::load( in + i ), l ), h ) );
+    for ( ; i < n; i++ ) out[i] = in[i] < lo ? lo : in[i] > hi ? hi : in[i];
+  }
+
+  //! out[i] = start + i * step. Computed per element so long ramps don't drift
+  static void ramp( T *out, T start, T step, long n ) {
+    long i = 0;
+    long const vn = n - n % W;
+    T first[W];
+    for ( long k = 0; k < W; k++ ) first[k] = start + T(k) * step;
+    V const base = Ops::load( first );
+    for ( ; i < vn; i += W ) Ops::store( out + i, Ops::add( base, Ops::set1( T(i) * step ) ) );
+    for ( ; i < n; i++ ) out[i] = start + T(i) * step;
+  }
+
+  //! out = in
+  static void copy( T *out, const T *in, long n ) {
+    long i = 0;
+    long const vn = n - n % W;
+    for ( ; i < vn; i += W ) Ops::store( out + i, Ops::load( in + i ) );
+    for ( ; i < n; i++ ) out[i] = in[i];
+  }
+
+  //! out = 0
+  static void clear( T *out, long n ) {
+    long i = 0;
+    long const vn = n - n % W;
+    V const z = Ops::set1( T(0) );
+    for ( ; i < vn; i += W ) Ops::store( out + i, z );
+    for ( ; i < n; i++ ) out[i] = T(0);
+  }
+
+  //! out[i] = sum over k < taps of coeffs[k] * (in[i + k] + in[i + 2 * taps - 1 - k]),
+  //  the folded branch of a symmetric FIR. in holds 2 * taps - 1 samples
+  //  of history before the block. Output must not alias the input
+  static void fir( T *out, const T *in, const T *coeffs, long taps, long n ) {
+    long i = 0;
+    long const vn = n - n % W;
+    long const span = 2 * taps - 1;
+    for ( ; i < vn; i += W ) {
+      V acc = Ops::set1( T(0) );
+      for ( long k = 0; k < taps; k++ ) {
+        acc = Ops::add( acc, Ops::mul( Ops::set1( coeffs[k] ),
+                                       Ops::add( Ops::load( in + i + k ), Ops::load( in + i + span - k ) ) ) );
+      }
+      Ops::store( out + i, acc );
+    }
+    for ( ; i < n; i++ ) {
+      T acc = 0;
+      for ( long k = 0; k < taps; k++ ) acc += coeffs[k] * (in[i + k] + in[i + span - k]);
+      out[i] = acc;
+    }
+  }
+};
@@ -0,0 +1,110 @@
+//
+//  TRnumeric.h
+//  TRextern
+//
+//  Copyright © 2026 Reactify. All rights reserved.
+//
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define TR_NUMERIC_SSE 1
+#elif defined(__aarch64__) || (defined(__arm__) && defined(__ARM_FP))
+#define TR_NUMERIC_ARM 1
+#endif
+
+//! Whether objects flush denormals while process() runs unless they call
+//  setFlushDenormals(). Off by default; define as 1 to turn it on for
+//  every object in the binary
+#ifndef TREXTERN_FLUSH_DENORMALS
+#define TREXTERN_FLUSH_DENORMALS 0
+#endif
+
+//! Sets flush-to-zero (and denormals-are-zero on x86) for its lifetime and
+//  restores the previous floating point mode when it goes out of scope.
+//  Does nothing on targets without a control register we know of.
+class DenormalGuard {
+public:
+  explicit DenormalGuard( bool enable = true ) : mEnabled(enable), mPrevious(0) {
+    if ( !mEnabled ) return;
+#if defined(TR_NUMERIC_SSE)
+    // FTZ is bit 15 and DAZ bit 6 of MXCSR
+    mPrevious = _mm_getcsr();
+    _mm_setcsr( (unsigned)mPrevious | 0x8040 );
+#elif defined(TR_NUMERIC_ARM)
+    // FZ is bit 24 of FPCR (AArch64) / FPSCR (ARMv7)
+    mPrevious = readControl();
+    writeControl( mPrevious | (uintptr_t(1) << 24) );
+#endif
+  }
+
+  ~DenormalGuard() {
+    if ( !mEnabled ) return;
+#if defined(TR_NUMERIC_SSE)
+    _mm_setcsr( (unsigned)mPrevious );
+#elif defined(TR_NUMERIC_ARM)
+    writeControl( mPrevious );
+#endif
+  }
+
+  DenormalGuard( const DenormalGuard& ) = delete;
+  DenormalGuard& operator=( const DenormalGuard& ) = delete;
+
+private:
+#if defined(TR_NUMERIC_ARM)
+  static uintptr_t readControl() {
+    uintptr_t value;
+#if defined(__aarch64__)
+    __asm__ __volatile__( "mrs %0, fpcr" : "=r"(value) );
+#else
+    __asm__ __volatile__( "vmrs %0, fpscr" : "=r"(value) );
+#endif
+    return value;
+  }
+  static void writeControl( uintptr_t value ) {
+#if defined(__aarch64__)
+    __asm__ __volatile__( "msr fpcr, %0" : : "r"(value) );
+#else
+    __asm__ __volatile__( "vmsr fpscr, %0" : : "r"(value) );
+#endif
+  }
+#endif
+
+  bool      mEnabled;
+  uintptr_t mPrevious;
+};
+
+//! What tr_scannumeric found
+enum class NumericFault { None, NaN, Inf, Denormal };
+
+//! Name of a fault for error messages
+inline const char* tr_numericfaultname( NumericFault fault ) {
+  switch ( fault ) {
+    case NumericFault::NaN:      return "NaN";
+    case NumericFault::Inf:      return "Inf";
+    case NumericFault::Denormal: return "denormal";
+    default:                     return "none";
+  }
+}
+
+//! Finds the first NaN, Inf or denormal sample in a buffer.
+//  Writes its position to index when one is found
+template<class T>
+inline NumericFault tr_scannumeric( const T *buffer, long n, long *index = nullptr ) {
+  for ( long i = 0; i < n; i++ ) {
+    NumericFault fault;
+    switch ( std::fpclassify( buffer[i] ) ) {
+      case FP_NAN:       fault = NumericFault::NaN;      break;
+      case FP_INFINITE:  fault = NumericFault::Inf;      break;
+      case FP_SUBNORMAL: fault = NumericFault::Denormal; break;
+      default: continue;
+    }
+    if ( index ) *index = i;
+    return fault;
+  }
+  return NumericFault::None;
+}
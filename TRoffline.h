@@ -0,0 +1,935 @@
+//
+//  TRoffline.h
+//  TRextern
+//
+//  Copyright © 2026 Reactify. All rights reserved.
+//
+
+// Offline host. Implements the part of the Pd API used by TRextern in
+// process, so externals can be instantiated, fed messages and run block by
+// block without Pd or Max, e.g. in unit tests and benchmarks.
+// Build with TREXTERN_OFFLINE defined; TRextern.h then includes this file
+// in place of m_pd.h and compiles its Pd code paths against it.
+//
+//   balance_tilde_setup();
+//   auto& host = OfflineHost::instance();
+//   OfflineObject obj( "balance~", { tr_atomfloat( 0.25 ) } );
+//   obj.sendFloat( 2, 0.5 );
+//   host.startDsp();
+//   host.tick();
+//   auto out = obj.output( 0 );
+
+#pragma once
+
+#ifndef PD
+#define PD
+#endif
+
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define PD_MAJOR_VERSION 0
+#define PD_MINOR_VERSION 54
+#define PD_BUGFIX_VERSION 0
+
+//! Types
+typedef intptr_t t_int;
+typedef float    t_float;
+typedef float    t_floatarg;
+typedef float    t_sample;
+
+typedef struct _symbol {
+  const char *s_name;
+  void      **s_thing;
+  struct _symbol *s_next;
+} t_symbol;
+
+typedef struct _gpointer t_gpointer;
+
+typedef union word {
+  t_float     w_float;
+  t_symbol   *w_symbol;
+  t_gpointer *w_gpointer;
+  int         w_index;
+} t_word;
+
+typedef enum {
+  A_NULL, A_FLOAT, A_SYMBOL, A_POINTER, A_SEMI, A_COMMA,
+  A_DEFFLOAT, A_DEFSYM, A_DOLLAR, A_DOLLSYM, A_GIMME, A_CANT
+} t_atomtype;
+
+typedef struct _atom {
+  t_atomtype a_type;
+  union word a_w;
+} t_atom;
+
+typedef struct _class  t_class;
+typedef struct _inlet  t_inlet;
+typedef struct _outlet t_outlet;
+typedef struct _clock  t_clock;
+typedef t_class       *t_pd;
+
+typedef struct _gobj {
+  t_pd          g_pd;
+  struct _gobj *g_next;
+} t_gobj;
+
+//! Inlets and outlets of a patchable object
+struct _offlineio {
+  std::vector<t_inlet*>  inlets;
+  std::vector<t_outlet*> outlets;
+};
+
+typedef struct _text {
+  t_gobj             te_g;
+  struct _offlineio *te_io;
+} t_object;
+#define ob_pd te_g.g_pd
+
+typedef void  (*t_method)(void);
+typedef void *(*t_newmethod)(void);
+
+typedef struct _signal {
+  int        s_n;
+  t_sample  *s_vec;
+  t_float    s_sr;
+  int        s_nchans;
+  int        s_isscalar;
+  std::vector<t_sample> s_storage;
+} t_signal;
+
+typedef t_int *(*t_perfroutine)(t_int *args);
+
+#define CLASS_DEFAULT      0
+#define CLASS_PD           1
+#define CLASS_GOBJ         2
+#define CLASS_PATCHABLE    3
+#define CLASS_NOINLET      8
+#define CLASS_MULTICHANNEL 0x100
+
+#define SETFLOAT(atom, f)  ((atom)->a_type = A_FLOAT,  (atom)->a_w.w_float  = (f))
+#define SETSYMBOL(atom, s) ((atom)->a_type = A_SYMBOL, (atom)->a_w.w_symbol = (s))
+
+//! Host side structures
+struct _offlinemethod {
+  t_symbol               *selector;
+  t_method                fn;
+  std::vector<t_atomtype> args;
+};
+
+struct _class {
+  t_symbol   *c_name;
+  t_newmethod c_new;
+  t_method    c_free;
+  size_t      c_size;
+  int         c_flags;
+  std::vector<t_atomtype>     c_newargs;
+  std::vector<_offlinemethod> c_methods;
+};
+
+struct _inlet {
+  t_object  *i_owner;
+  t_pd      *i_dest;
+  t_symbol  *i_symfrom;
+  t_symbol  *i_symto;
+  t_float   *i_floatslot;
+  t_symbol **i_symbolslot;
+  t_float    i_signalvalue;
+};
+
+//! A message sent by an outlet
+struct OfflineMessage {
+  t_symbol           *selector;
+  std::vector<t_atom> atoms;
+  //! Logical time of the message in milliseconds
+  double              time;
+};
+
+struct _outlet {
+  t_object   *o_owner;
+  t_symbol   *o_symbol;
+  std::vector<OfflineMessage> o_messages;
+};
+
+struct _clock {
+  void    *c_owner;
+  t_method c_fn;
+  double   c_settime;
+};
+
+t_symbol *gensym( const char *s );
+
+//! Built in symbols. References so every translation unit shares one symbol
+static t_symbol &s_bang     = *gensym( "bang" );
+static t_symbol &s_float    = *gensym( "float" );
+static t_symbol &s_symbol   = *gensym( "symbol" );
+static t_symbol &s_list     = *gensym( "list" );
+static t_symbol &s_anything = *gensym( "anything" );
+static t_symbol &s_signal   = *gensym( "signal" );
+static t_symbol &s_pointer  = *gensym( "pointer" );
+static t_symbol &s_         = *gensym( "" );
+
+class OfflineObject;
+
+//! State of the offline host. There is one per process
+class OfflineHost {
+public:
+  static OfflineHost& instance() {
+    static OfflineHost host;
+    return host;
+  }
+
+  OfflineHost( const OfflineHost& ) = delete;
+  OfflineHost& operator=( const OfflineHost& ) = delete;
+
+  //! Audio settings. Take effect on the next startDsp()
+  void    setSampleRate( double sampleRate ) { mSampleRate = sampleRate; }
+  void    setBlockSize( int blockSize )      { mBlockSize = blockSize; }
+  double  sampleRate() const { return mSampleRate; }
+  int     blockSize()  const { return mBlockSize; }
+
+  //! Builds the DSP chain of every live object, like switching DSP on in Pd
+  void    startDsp();
+  void    stopDsp();
+  bool    isDspRunning() const { return mDspRunning; }
+
+  //! Runs clocks due before the next block boundary, then one DSP block
+  void    tick( long blocks = 1 );
+  //! Moves logical time forward within the current block, running clocks.
+  //  Messages sent afterwards arrive that many samples into the block
+  void    advance( long samples );
+  //! Logical time in milliseconds
+  double  time() const { return mTime; }
+
+  //! Console output. Posts are collected here and printed when echo is on
+  void    setEcho( bool echo ) { mEcho = echo; }
+  const std::vector<std::string>& log() const { return mLog; }
+  void    clearLog() { mLog.clear(); }
+  size_t  errorCount() const { return mErrors; }
+
+  //! Mutex behind sys_lock(). Held by the host while it runs objects
+  std::mutex& lock() { return mLock; }
+
+  // Used by the Pd API implementation
+  std::map<std::string, t_class*>        classes;
+  std::vector<OfflineObject*>            objects;
+  std::vector<std::vector<t_int>>        chain;
+  std::vector<t_clock*>                  clocks;
+  std::unordered_map<std::string, std::unique_ptr<t_symbol>> symbols;
+
+  void    print( bool error, const char *fmt, va_list args );
+  void    runClocks( double until );
+
+private:
+  OfflineHost() : mSampleRate(44100), mBlockSize(64), mTime(0), mBlockTime(0),
+                  mDspRunning(false), mEcho(false), mErrors(0) {}
+
+  double  blockMs() const { return 1000.0 * mBlockSize / mSampleRate; }
+
+  double  mSampleRate;
+  int     mBlockSize;
+  double  mTime;
+  double  mBlockTime;
+  bool    mDspRunning;
+  bool    mEcho;
+  size_t  mErrors;
+  std::vector<std::string> mLog;
+  std::mutex mLock;
+};
+
+//! An instance of a registered class, created as if typed into an object box
+class OfflineObject {
+public:
+  OfflineObject( std::string name, std::vector<t_atom> args = {} );
+  ~OfflineObject();
+  OfflineObject( const OfflineObject& ) = delete;
+  OfflineObject& operator=( const OfflineObject& ) = delete;
+
+  //! False if the class doesn't exist or its constructor failed
+  bool        isValid() const { return mObject != nullptr; }
+  t_object*   object()  const { return mObject; }
+
+  //! Messages sent to an inlet, going through its type checks and
+  //  translation like a patch connection would
+  void        sendBang    ( int inlet );
+  void        sendFloat   ( int inlet, t_float f );
+  void        sendSymbol  ( int inlet, const char *s );
+  void        sendList    ( int inlet, std::vector<t_atom> atoms );
+  void        sendAnything( int inlet, const char *selector, std::vector<t_atom> atoms = {} );
+  //! Message sent straight to the object, like a named receiver would
+  void        message( const char *selector, std::vector<t_atom> atoms = {} );
+
+  int         inletCount()  const;
+  int         outletCount() const;
+
+  //! Everything sent by an outlet since it was last cleared
+  const std::vector<OfflineMessage>& messages( int outlet ) const;
+  void        clearMessages();
+
+  //! Channels connected to each signal inlet from the next startDsp().
+  //  0 leaves an inlet unconnected, so it receives its last float as a
+  //  scalar. Inlets default to one connected channel
+  void        setInputChannels( std::vector<int> channels ) { mInputChannels = channels; }
+
+  //! Buffers of the current DSP chain. Channels of an inlet or outlet are
+  //  stored one after the other
+  t_sample*   input ( int inlet,  int channel = 0 );
+  t_sample*   output( int outlet, int channel = 0 );
+  int         outputChannels( int outlet ) const;
+
+  // Used by the host
+  void        compileDsp();
+  void        fillScalars();
+
+private:
+  std::vector<t_inlet*> signalInlets() const;
+  int         signalOutletCount() const;
+  void        send( int inlet, t_symbol *s, int argc, t_atom *argv );
+
+  t_object*   mObject;
+  std::vector<int>                       mInputChannels;
+  std::vector<std::unique_ptr<t_signal>> mSignals;
+  int         mSignalIns;
+};
+
+//! Atoms for arguments and messages
+inline t_atom tr_atomfloat( t_float f ) {
+  t_atom a;
+  SETFLOAT( &a, f );
+  return a;
+}
+
+inline t_atom tr_atomsymbol( const char *s ) {
+  t_atom a;
+  SETSYMBOL( &a, gensym( s ) );
+  return a;
+}
+
+//! Average wall clock time of fn in nanoseconds, over iterations calls
+template<class Fn>
+inline double tr_offlinemeasure( long iterations, Fn&& fn ) {
+  using clock = std::chrono::steady_clock;
+  auto const start = clock::now();
+  for ( long i = 0; i < iterations; i++ ) fn();
+  auto const elapsed = std::chrono::duration<double, std::nano>( clock::now() - start ).count();
+  return iterations > 0 ? elapsed / iterations : 0;
+}
+
+//------------------------------------------------------------------------------
+//! Pd API
+//------------------------------------------------------------------------------
+inline t_symbol *gensym( const char *s ) {
+  auto& symbols = OfflineHost::instance().symbols;
+  auto& sym = symbols[s];
+  if ( !sym ) {
+    sym.reset( new t_symbol{ nullptr, nullptr, nullptr } );
+    // Name points at the key, which never moves
+    sym->s_name = symbols.find( s )->first.c_str();
+  }
+  return sym.get();
+}
+
+inline void post( const char *fmt, ... ) {
+  va_list args;
+  va_start( args, fmt );
+  OfflineHost::instance().print( false, fmt, args );
+  va_end( args );
+}
+
+inline void pd_error( const void * /*object*/, const char *fmt, ... ) {
+  va_list args;
+  va_start( args, fmt );
+  OfflineHost::instance().print( true, fmt, args );
+  va_end( args );
+}
+
+inline void logpost( const void * /*object*/, const int level, const char *fmt, ... ) {
+  va_list args;
+  va_start( args, fmt );
+  OfflineHost::instance().print( level <= 1, fmt, args );
+  va_end( args );
+}
+
+inline t_float atom_getfloat( const t_atom *a ) {
+  return a->a_type == A_FLOAT ? a->a_w.w_float : 0;
+}
+
+inline t_int atom_getint( const t_atom *a ) {
+  return (t_int)atom_getfloat( a );
+}
+
+inline t_symbol *atom_getsymbol( const t_atom *a ) {
+  return a->a_type == A_SYMBOL ? a->a_w.w_symbol : &s_symbol;
+}
+
+inline t_float atom_getfloatarg( int which, int argc, const t_atom *argv ) {
+  return which < argc ? atom_getfloat( argv + which ) : 0;
+}
+
+inline void *getbytes( size_t nbytes ) { return calloc( 1, nbytes ? nbytes : 1 ); }
+inline void  freebytes( void *x, size_t /*nbytes*/ ) { free( x ); }
+
+//! Classes
+inline t_class *class_new( t_symbol *name, t_newmethod newmethod, t_method freemethod,
+                           size_t size, int flags, t_atomtype arg1, ... ) {
+  auto c = new t_class{ name, newmethod, freemethod, size, flags, {}, {} };
+  va_list ap;
+  va_start( ap, arg1 );
+  for ( auto type = arg1; type != A_NULL; type = (t_atomtype)va_arg( ap, int ) ) {
+    c->c_newargs.push_back( type );
+  }
+  va_end( ap );
+  auto& classes = OfflineHost::instance().classes;
+  delete classes[name->s_name];
+  classes[name->s_name] = c;
+  return c;
+}
+
+inline void class_addmethod( t_class *c, t_method fn, t_symbol *sel, t_atomtype arg1, ... ) {
+  _offlinemethod m{ sel, fn, {} };
+  va_list ap;
+  va_start( ap, arg1 );
+  for ( auto type = arg1; type != A_NULL; type = (t_atomtype)va_arg( ap, int ) ) {
+    m.args.push_back( type );
+  }
+  va_end( ap );
+  for ( auto& it : c->c_methods ) {
+    if ( it.selector == sel ) { it = m; return; }
+  }
+  c->c_methods.push_back( m );
+}
+
+inline void class_addbang    ( t_class *c, t_method fn ) { class_addmethod( c, fn, &s_bang, A_NULL ); }
+inline void class_addfloat   ( t_class *c, t_method fn ) { class_addmethod( c, fn, &s_float, A_FLOAT, A_NULL ); }
+inline void class_addsymbol  ( t_class *c, t_method fn ) { class_addmethod( c, fn, &s_symbol, A_SYMBOL, A_NULL ); }
+inline void class_addlist    ( t_class *c, t_method fn ) { class_addmethod( c, fn, &s_list, A_GIMME, A_NULL ); }
+inline void class_addanything( t_class *c, t_method fn ) { class_addmethod( c, fn, &s_anything, A_GIMME, A_NULL ); }
+
+inline const char *class_getname( const t_class *c ) { return c->c_name->s_name; }
+
+//! Objects
+inline bool tr_offlinepatchable( const t_class *c ) {
+  auto const type = c->c_flags & 3;
+  return type == 0 || type == CLASS_PATCHABLE;
+}
+
+inline t_pd *pd_new( t_class *cls ) {
+  auto x = (t_pd *)getbytes( cls->c_size );
+  *x = cls;
+  if ( tr_offlinepatchable( cls ) ) {
+    ((t_object *)x)->te_io = new _offlineio;
+  }
+  return x;
+}
+
+void inlet_free( t_inlet *x );
+void outlet_free( t_outlet *x );
+
+inline void pd_free( t_pd *x ) {
+  auto c = *x;
+  if ( c->c_free ) ((void (*)(t_pd *))c->c_free)( x );
+  if ( tr_offlinepatchable( c ) ) {
+    auto io = ((t_object *)x)->te_io;
+    while ( !io->inlets.empty() )  inlet_free( io->inlets.back() );
+    while ( !io->outlets.empty() ) outlet_free( io->outlets.back() );
+    delete io;
+  }
+  freebytes( x, c->c_size );
+}
+
+//! Calls a method with arguments converted to its signature. Supports the
+//  signatures TRextern registers: up to two float/symbol arguments, A_GIMME
+//  and A_CANT methods with no arguments
+inline bool tr_offlinecall( t_pd *x, const _offlinemethod& m, t_symbol *s, int argc, t_atom *argv ) {
+  if ( m.args.size() == 1 && m.args[0] == A_GIMME ) {
+    ((void (*)(t_pd *, t_symbol *, int, t_atom *))m.fn)( x, s, argc, argv );
+    return true;
+  }
+  if ( m.args.size() > 2 ) {
+    pd_error( x, "%s: offline host can't call '%s' (unsupported signature)", class_getname( *x ), s->s_name );
+    return false;
+  }
+  t_float   f[2] = { 0, 0 };
+  t_symbol *y[2] = { &s_, &s_ };
+  bool      isFloat[2] = { false, false };
+  for ( size_t i = 0; i < m.args.size(); i++ ) {
+    auto const type = m.args[i];
+    auto const given = (int)i < argc;
+    if ( type == A_FLOAT || type == A_DEFFLOAT ) {
+      isFloat[i] = true;
+      if ( given && argv[i].a_type != A_FLOAT ) {
+        pd_error( x, "%s: bad arguments for message '%s'", class_getname( *x ), s->s_name );
+        return false;
+      }
+      if ( given ) f[i] = argv[i].a_w.w_float;
+    } else if ( type == A_SYMBOL || type == A_DEFSYM ) {
+      if ( given && argv[i].a_type != A_SYMBOL ) {
+        pd_error( x, "%s: bad arguments for message '%s'", class_getname( *x ), s->s_name );
+        return false;
+      }
+      if ( given ) y[i] = argv[i].a_w.w_symbol;
+    } else {
+      pd_error( x, "%s: offline host can't call '%s' (unsupported signature)", class_getname( *x ), s->s_name );
+      return false;
+    }
+  }
+  switch ( m.args.size() ) {
+    case 0: ((void (*)(t_pd *))m.fn)( x ); break;
+    case 1:
+      if ( isFloat[0] ) ((void (*)(t_pd *, t_floatarg))m.fn)( x, f[0] );
+      else              ((void (*)(t_pd *, t_symbol *))m.fn)( x, y[0] );
+      break;
+    case 2:
+      if ( isFloat[0] && isFloat[1] )  ((void (*)(t_pd *, t_floatarg, t_floatarg))m.fn)( x, f[0], f[1] );
+      else if ( isFloat[0] )           ((void (*)(t_pd *, t_floatarg, t_symbol *))m.fn)( x, f[0], y[1] );
+      else if ( isFloat[1] )           ((void (*)(t_pd *, t_symbol *, t_floatarg))m.fn)( x, y[0], f[1] );
+      else                             ((void (*)(t_pd *, t_symbol *, t_symbol *))m.fn)( x, y[0], y[1] );
+      break;
+  }
+  return true;
+}
+
+inline void pd_typedmess( t_pd *x, t_symbol *s, int argc, t_atom *argv ) {
+  auto c = *x;
+  for ( auto& m : c->c_methods ) {
+    if ( m.selector == s ) {
+      tr_offlinecall( x, m, s, argc, argv );
+      return;
+    }
+  }
+  // Lists and single floats/symbols fall back like they do in Pd
+  if ( s == &s_list && argc == 1 && argv[0].a_type == A_FLOAT ) {
+    pd_typedmess( x, &s_float, argc, argv );
+    return;
+  }
+  // Bangs, floats and symbols go to a list method as lists without a selector
+  auto const single = (s == &s_bang && argc == 0) || ((s == &s_float || s == &s_symbol) && argc == 1);
+  if ( single ) {
+    for ( auto& m : c->c_methods ) {
+      if ( m.selector == &s_list ) {
+        ((void (*)(t_pd *, t_symbol *, int, t_atom *))m.fn)( x, nullptr, argc, argv );
+        return;
+      }
+    }
+  }
+  for ( auto& m : c->c_methods ) {
+    if ( m.selector == &s_anything ) {
+      ((void (*)(t_pd *, t_symbol *, int, t_atom *))m.fn)( x, s, argc, argv );
+      return;
+    }
+  }
+  pd_error( x, "%s: no method for '%s'", class_getname( c ), s->s_name );
+}
+
+//! Inlets
+inline t_inlet *tr_offlineinlet( t_object *owner, t_pd *dest, t_symbol *s1, t_symbol *s2 ) {
+  auto x = new t_inlet{ owner, dest, s1, s2, nullptr, nullptr, 0 };
+  owner->te_io->inlets.push_back( x );
+  return x;
+}
+
+inline t_inlet *inlet_new( t_object *owner, t_pd *dest, t_symbol *s1, t_symbol *s2 ) {
+  return tr_offlineinlet( owner, dest, s1, s2 );
+}
+
+inline t_inlet *floatinlet_new( t_object *owner, t_float *fp ) {
+  auto x = tr_offlineinlet( owner, nullptr, &s_float, nullptr );
+  x->i_floatslot = fp;
+  return x;
+}
+
+inline t_inlet *symbolinlet_new( t_object *owner, t_symbol **sp ) {
+  auto x = tr_offlineinlet( owner, nullptr, &s_symbol, nullptr );
+  x->i_symbolslot = sp;
+  return x;
+}
+
+inline t_inlet *signalinlet_new( t_object *owner, t_float f ) {
+  auto x = tr_offlineinlet( owner, &owner->ob_pd, &s_signal, &s_signal );
+  x->i_signalvalue = f;
+  return x;
+}
+
+inline void inlet_free( t_inlet *x ) {
+  auto& inlets = x->i_owner->te_io->inlets;
+  inlets.erase( std::remove( inlets.begin(), inlets.end(), x ), inlets.end() );
+  delete x;
+}
+
+//! Delivers a message arriving at an inlet the way Pd's inlet class does
+inline void tr_offlineinletmess( t_inlet *x, t_symbol *s, int argc, t_atom *argv ) {
+  auto const single = argc == 1 && (s == &s_float || s == &s_symbol || s == &s_list);
+  if ( x->i_floatslot ) {
+    if ( single && argv[0].a_type == A_FLOAT ) { *x->i_floatslot = argv[0].a_w.w_float; return; }
+  } else if ( x->i_symbolslot ) {
+    if ( single && argv[0].a_type == A_SYMBOL ) { *x->i_symbolslot = argv[0].a_w.w_symbol; return; }
+  } else if ( x->i_symfrom == &s_signal ) {
+    if ( s == &s_float ) { x->i_signalvalue = argv[0].a_w.w_float; return; }
+  } else if ( !x->i_symfrom ) {
+    pd_typedmess( x->i_dest, s, argc, argv );
+    return;
+  } else if ( x->i_symfrom == s ) {
+    pd_typedmess( x->i_dest, x->i_symto, argc, argv );
+    return;
+  } else if ( s == &s_list && argc == 1 && argv[0].a_type == A_FLOAT && x->i_symfrom == &s_float ) {
+    pd_typedmess( x->i_dest, x->i_symto, argc, argv );
+    return;
+  } else if ( s == &s_list && argc == 0 && x->i_symfrom == &s_bang ) {
+    pd_typedmess( x->i_dest, x->i_symto, 0, argv );
+    return;
+  }
+  pd_error( x->i_owner, "inlet: expected '%s' but got '%s'",
+            x->i_symfrom ? x->i_symfrom->s_name : "anything", s->s_name );
+}
+
+//! Outlets
+inline t_outlet *outlet_new( t_object *owner, t_symbol *s ) {
+  auto x = new t_outlet{ owner, s, {} };
+  owner->te_io->outlets.push_back( x );
+  return x;
+}
+
+inline void outlet_free( t_outlet *x ) {
+  auto& outlets = x->o_owner->te_io->outlets;
+  outlets.erase( std::remove( outlets.begin(), outlets.end(), x ), outlets.end() );
+  delete x;
+}
+
+inline t_symbol *outlet_getsymbol( t_outlet *x ) { return x->o_symbol; }
+
+inline void outlet_anything( t_outlet *x, t_symbol *s, int argc, t_atom *argv ) {
+  x->o_messages.push_back( { s, std::vector<t_atom>( argv, argv + argc ), OfflineHost::instance().time() } );
+}
+
+inline void outlet_list( t_outlet *x, t_symbol * /*s*/, int argc, t_atom *argv ) {
+  outlet_anything( x, &s_list, argc, argv );
+}
+
+inline void outlet_bang( t_outlet *x ) {
+  outlet_anything( x, &s_bang, 0, nullptr );
+}
+
+inline void outlet_float( t_outlet *x, t_float f ) {
+  auto a = tr_atomfloat( f );
+  outlet_anything( x, &s_float, 1, &a );
+}
+
+inline void outlet_symbol( t_outlet *x, t_symbol *s ) {
+  t_atom a;
+  SETSYMBOL( &a, s );
+  outlet_anything( x, &s_symbol, 1, &a );
+}
+
+//! Clocks. Logical time is kept in milliseconds
+inline t_clock *clock_new( void *owner, t_method fn ) {
+  auto x = new t_clock{ owner, fn, -1 };
+  OfflineHost::instance().clocks.push_back( x );
+  return x;
+}
+
+inline void clock_set  ( t_clock *x, double systime )   { x->c_settime = systime; }
+inline void clock_delay( t_clock *x, double delaytime ) {
+  x->c_settime = OfflineHost::instance().time() + (delaytime > 0 ? delaytime : 0);
+}
+inline void clock_unset( t_clock *x ) { x->c_settime = -1; }
+
+inline void clock_free( t_clock *x ) {
+  auto& clocks = OfflineHost::instance().clocks;
+  clocks.erase( std::remove( clocks.begin(), clocks.end(), x ), clocks.end() );
+  delete x;
+}
+
+inline double clock_getlogicaltime() { return OfflineHost::instance().time(); }
+inline double clock_gettimesince( double prevsystime ) { return clock_getlogicaltime() - prevsystime; }
+inline double clock_getsystimeafter( double delaytime ) { return clock_getlogicaltime() + delaytime; }
+
+inline double clock_gettimesincewithunits( double prevsystime, double units, int sampflag ) {
+  auto const ms = clock_gettimesince( prevsystime );
+  if ( sampflag ) return ms * OfflineHost::instance().sampleRate() / (1000.0 * units);
+  return ms / units;
+}
+
+inline void sys_lock()    { OfflineHost::instance().lock().lock(); }
+inline void sys_unlock()  { OfflineHost::instance().lock().unlock(); }
+inline int  sys_trylock() { return OfflineHost::instance().lock().try_lock() ? 0 : 1; }
+
+//! DSP
+inline t_float sys_getsr()      { return (t_float)OfflineHost::instance().sampleRate(); }
+inline int     sys_getblksize() { return OfflineHost::instance().blockSize(); }
+
+inline void dsp_addv( t_perfroutine f, int n, t_int *vec ) {
+  std::vector<t_int> routine( 1, (t_int)f );
+  routine.insert( routine.end(), vec, vec + n );
+  OfflineHost::instance().chain.push_back( routine );
+}
+
+inline void dsp_add( t_perfroutine f, int n, ... ) {
+  std::vector<t_int> args( n );
+  va_list ap;
+  va_start( ap, n );
+  for ( auto i = 0; i < n; i++ ) args[i] = va_arg( ap, t_int );
+  va_end( ap );
+  dsp_addv( f, n, args.data() );
+}
+
+inline void signal_setmultiout( t_signal **sig, int nchans ) {
+  auto s = *sig;
+  s->s_nchans = nchans > 0 ? nchans : 1;
+  s->s_storage.assign( (size_t)s->s_n * s->s_nchans, 0 );
+  s->s_vec = s->s_storage.data();
+}
+
+//------------------------------------------------------------------------------
+//! OfflineHost
+//------------------------------------------------------------------------------
+inline void OfflineHost::print( bool error, const char *fmt, va_list args ) {
+  char buffer[1024];
+  vsnprintf( buffer, sizeof buffer, fmt, args );
+  mLog.push_back( (error ? "error: " : "") + std::string( buffer ) );
+  if ( error ) mErrors++;
+  if ( mEcho ) fprintf( error ? stderr : stdout, "%s\n", mLog.back().c_str() );
+}
+
+//------------------------------------------------------------------------------
+inline void OfflineHost::runClocks( double until ) {
+  // Earliest first, ties in the order they were set. Clocks may set or
+  // free clocks, so look the next one up every time
+  for ( ;; ) {
+    t_clock *next = nullptr;
+    for ( auto c : clocks ) {
+      if ( c->c_settime >= 0 && c->c_settime < until && (!next || c->c_settime < next->c_settime) ) next = c;
+    }
+    if ( !next ) break;
+    if ( next->c_settime > mTime ) mTime = next->c_settime;
+    next->c_settime = -1;
+    ((void (*)(void *))next->c_fn)( next->c_owner );
+  }
+}
+
+//------------------------------------------------------------------------------
+inline void OfflineHost::startDsp() {
+  std::lock_guard<std::mutex> guard( mLock );
+  chain.clear();
+  mDspRunning = true;
+  for ( auto obj : objects ) obj->compileDsp();
+}
+
+//------------------------------------------------------------------------------
+inline void OfflineHost::stopDsp() {
+  std::lock_guard<std::mutex> guard( mLock );
+  chain.clear();
+  mDspRunning = false;
+}
+
+//------------------------------------------------------------------------------
+inline void OfflineHost::tick( long blocks ) {
+  std::lock_guard<std::mutex> guard( mLock );
+  for ( long b = 0; b < blocks; b++ ) {
+    auto const next = mBlockTime + blockMs();
+    runClocks( next );
+    mTime = mBlockTime = next;
+    if ( !mDspRunning ) continue;
+    for ( auto obj : objects ) obj->fillScalars();
+    for ( auto& routine : chain ) {
+      ((t_perfroutine)routine[0])( routine.data() );
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+inline void OfflineHost::advance( long samples ) {
+  std::lock_guard<std::mutex> guard( mLock );
+  auto const target = mTime + 1000.0 * samples / mSampleRate;
+  runClocks( target );
+  mTime = target;
+}
+
+//------------------------------------------------------------------------------
+//! OfflineObject
+//------------------------------------------------------------------------------
+inline OfflineObject::OfflineObject( std::string name, std::vector<t_atom> args ) : mObject(nullptr), mSignalIns(0) {
+  auto& host = OfflineHost::instance();
+  auto it = host.classes.find( name );
+  if ( it == host.classes.end() ) {
+    pd_error( nullptr, "%s ... couldn't create", name.c_str() );
+    return;
+  }
+  auto c = it->second;
+  std::lock_guard<std::mutex> guard( host.lock() );
+  if ( c->c_newargs.size() == 1 && c->c_newargs[0] == A_GIMME ) {
+    mObject = (t_object *)((void *(*)(t_symbol *, int, t_atom *))c->c_new)( c->c_name, (int)args.size(), args.data() );
+  } else if ( c->c_newargs.empty() ) {
+    mObject = (t_object *)((void *(*)())c->c_new)();
+  } else {
+    pd_error( nullptr, "%s: offline host only creates objects taking A_GIMME or no arguments", name.c_str() );
+  }
+  if ( mObject ) host.objects.push_back( this );
+}
+
+//------------------------------------------------------------------------------
+inline OfflineObject::~OfflineObject() {
+  if ( !mObject ) return;
+  auto& host = OfflineHost::instance();
+  std::lock_guard<std::mutex> guard( host.lock() );
+  // The object's perform routines go with it
+  auto& chain = host.chain;
+  chain.erase( std::remove_if( chain.begin(), chain.end(), [this]( const std::vector<t_int>& r ) {
+    return r.size() > 1 && (t_object *)r[1] == mObject;
+  } ), chain.end() );
+  auto& objects = host.objects;
+  objects.erase( std::remove( objects.begin(), objects.end(), this ), objects.end() );
+  pd_free( &mObject->ob_pd );
+}
+
+//------------------------------------------------------------------------------
+inline void OfflineObject::send( int inlet, t_symbol *s, int argc, t_atom *argv ) {
+  if ( !mObject ) return;
+  std::lock_guard<std::mutex> guard( OfflineHost::instance().lock() );
+  auto& inlets = mObject->te_io->inlets;
+  if ( inlet < 0 || inlet >= (int)inlets.size() ) {
+    pd_error( mObject, "%s: no inlet %d", class_getname( mObject->ob_pd ), inlet );
+    return;
+  }
+  tr_offlineinletmess( inlets[inlet], s, argc, argv );
+}
+
+inline void OfflineObject::sendBang( int inlet ) { send( inlet, &s_bang, 0, nullptr ); }
+
+inline void OfflineObject::sendFloat( int inlet, t_float f ) {
+  auto a = tr_atomfloat( f );
+  send( inlet, &s_float, 1, &a );
+}
+
+inline void OfflineObject::sendSymbol( int inlet, const char *s ) {
+  auto a = tr_atomsymbol( s );
+  send( inlet, &s_symbol, 1, &a );
+}
+
+inline void OfflineObject::sendList( int inlet, std::vector<t_atom> atoms ) {
+  send( inlet, &s_list, (int)atoms.size(), atoms.data() );
+}
+
+inline void OfflineObject::sendAnything( int inlet, const char *selector, std::vector<t_atom> atoms ) {
+  send( inlet, gensym( selector ), (int)atoms.size(), atoms.data() );
+}
+
+//------------------------------------------------------------------------------
+inline void OfflineObject::message( const char *selector, std::vector<t_atom> atoms ) {
+  if ( !mObject ) return;
+  std::lock_guard<std::mutex> guard( OfflineHost::instance().lock() );
+  pd_typedmess( &mObject->ob_pd, gensym( selector ), (int)atoms.size(), atoms.data() );
+}
+
+//------------------------------------------------------------------------------
+inline int OfflineObject::inletCount() const {
+  return mObject ? (int)mObject->te_io->inlets.size() : 0;
+}
+
+inline int OfflineObject::outletCount() const {
+  return mObject ? (int)mObject->te_io->outlets.size() : 0;
+}
+
+//------------------------------------------------------------------------------
+inline const std::vector<OfflineMessage>& OfflineObject::messages( int outlet ) const {
+  return mObject->te_io->outlets.at( outlet )->o_messages;
+}
+
+inline void OfflineObject::clearMessages() {
+  if ( !mObject ) return;
+  for ( auto o : mObject->te_io->outlets ) o->o_messages.clear();
+}
+
+//------------------------------------------------------------------------------
+inline std::vector<t_inlet*> OfflineObject::signalInlets() const {
+  std::vector<t_inlet*> result;
+  for ( auto i : mObject->te_io->inlets ) {
+    if ( i->i_symfrom == &s_signal ) result.push_back( i );
+  }
+  return result;
+}
+
+inline int OfflineObject::signalOutletCount() const {
+  int count = 0;
+  for ( auto o : mObject->te_io->outlets ) {
+    if ( o->o_symbol == &s_signal ) count++;
+  }
+  return count;
+}
+
+//------------------------------------------------------------------------------
+inline void OfflineObject::compileDsp() {
+  mSignals.clear();
+  auto const inlets = signalInlets();
+  auto const outs   = signalOutletCount();
+  mSignalIns = (int)inlets.size();
+  if ( mSignalIns + outs == 0 ) return;
+
+  auto& host = OfflineHost::instance();
+  auto const n = host.blockSize();
+  std::vector<t_signal*> sp;
+  for ( auto i = 0; i < mSignalIns + outs; i++ ) {
+    auto channels = 1;
+    auto scalar   = false;
+    if ( i < mSignalIns && i < (int)mInputChannels.size() ) {
+      channels = mInputChannels[i] > 0 ? mInputChannels[i] : 1;
+      scalar   = mInputChannels[i] <= 0;
+    }
+    std::unique_ptr<t_signal> s( new t_signal );
+    s->s_n        = n;
+    s->s_sr       = (t_float)host.sampleRate();
+    s->s_isscalar = scalar;
+    s->s_nchans   = channels;
+    s->s_storage.assign( (size_t)n * channels, 0 );
+    s->s_vec      = s->s_storage.data();
+    sp.push_back( s.get() );
+    mSignals.push_back( std::move( s ) );
+  }
+
+  for ( auto& m : mObject->ob_pd->c_methods ) {
+    if ( m.selector == gensym( "dsp" ) ) {
+      ((void (*)(t_pd *, t_signal **))m.fn)( &mObject->ob_pd, sp.data() );
+      return;
+    }
+  }
+  pd_error( mObject, "%s: no method for 'dsp'", class_getname( mObject->ob_pd ) );
+}
+
+//------------------------------------------------------------------------------
+inline void OfflineObject::fillScalars() {
+  auto const inlets = signalInlets();
+  for ( auto i = 0; i < mSignalIns && i < (int)mSignals.size() && i < (int)inlets.size(); i++ ) {
+    auto& s = mSignals[i];
+    if ( s->s_isscalar ) std::fill( s->s_storage.begin(), s->s_storage.end(), inlets[i]->i_signalvalue );
+  }
+}
+
+//------------------------------------------------------------------------------
+inline t_sample *OfflineObject::input( int inlet, int channel ) {
+  if ( inlet < 0 || inlet >= mSignalIns ) return nullptr;
+  auto& s = mSignals[inlet];
+  return channel < s->s_nchans ? s->s_vec + (size_t)channel * s->s_n : nullptr;
+}
+
+inline t_sample *OfflineObject::output( int outlet, int channel ) {
+  auto const idx = mSignalIns + outlet;
+  if ( outlet < 0 || idx >= (int)mSignals.size() ) return nullptr;
+  auto& s = mSignals[idx];
+  return channel < s->s_nchans ? s->s_vec + (size_t)channel * s->s_n : nullptr;
+}
+
+inline int OfflineObject::outputChannels( int outlet ) const {
+  auto const idx = mSignalIns + outlet;
+  if ( outlet < 0 || idx >= (int)mSignals.size() ) return 0;
+  return mSignals[idx]->s_nchans;
+}
@@ -0,0 +1,196 @@
+//
+//  TRoversample.h
+//  TRextern
+//
+//  Copyright © 2026 Reactify. All rights reserved.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "TRkernels.h"
+
+//! Kaiser window parameter of the halfband filters, for about 100 dB of
+//  image and alias rejection
+#ifndef TREXTERN_HALFBAND_BETA
+#define TREXTERN_HALFBAND_BETA 9.6
+#endif
+
+//! One 2x stage for one channel: a halfband lowpass run as two polyphase
+//  branches. Every other tap of a halfband filter is zero apart from the
+//  centre one, so one branch is a symmetric FIR and the other a plain
+//  delay. Up and down each delay the signal by 2 * taps - 1 samples at
+//  the higher rate
+template<class T>
+class Halfband {
+public:
+  Halfband() : mTaps(0) {}
+
+  //! Main thread. taps is the number of coefficient pairs of the FIR
+  //  branch; the whole filter is 4 * taps - 1 long. blockSize is the
+  //  longest block up() and down() get, at the lower rate
+  void prepare( long taps, long blockSize ) {
+    mTaps = taps;
+    auto const span   = 2 * taps - 1;
+    auto const centre = (double)span;
+    // Windowed sinc cut off at a quarter of the higher rate. The FIR
+    // branch takes the even taps, doubled for the gain lost to upsampling
+    auto bessel = []( double x ) {
+      double sum = 1, term = 1;
+      for ( int k = 1; k < 32; k++ ) {
+        term *= (x / (2 * k)) * (x / (2 * k));
+        sum  += term;
+      }
+      return sum;
+    };
+    auto const beta = TREXTERN_HALFBAND_BETA;
+    mCoeffs.resize( taps );
+    for ( long k = 0; k < taps; k++ ) {
+      auto const j = 2.0 * k;
+      auto const t = (j - centre) / 2;
+      auto const r = (j - centre) / centre;
+      auto const window = bessel( beta * std::sqrt( 1 - r * r ) ) / bessel( beta );
+      mCoeffs[k] = T(std::sin( M_PI * t ) / (M_PI * t) * window);
+    }
+    mUp.assign( span + blockSize, T(0) );
+    mEven.assign( span + blockSize, T(0) );
+    mOdd.assign( taps + blockSize, T(0) );
+    mBranch.assign( blockSize, T(0) );
+  }
+
+  //! Delay of up() followed by down(), in samples at the lower rate
+  long latency() const { return 2 * mTaps - 1; }
+
+  //! Audio thread. n samples in, 2n out
+  void up( const T *in, T *out, long n ) {
+    auto const span = 2 * mTaps - 1;
+    auto history = mUp.data();
+    std::copy( in, in + n, history + span );
+    tr_fir( mBranch.data(), history, mCoeffs.data(), mTaps, n );
+    for ( long i = 0; i < n; i++ ) {
+      out[2 * i]     = mBranch[i];
+      out[2 * i + 1] = history[i + mTaps];
+    }
+    std::copy( history + n, history + n + span, history );
+  }
+
+  //! Audio thread. 2n samples in, n out
+  void down( const T *in, T *out, long n ) {
+    auto const span = 2 * mTaps - 1;
+    auto even = mEven.data();
+    auto odd  = mOdd.data();
+    for ( long i = 0; i < n; i++ ) {
+      even[span + i]  = in[2 * i];
+      odd[mTaps + i]  = in[2 * i + 1];
+    }
+    tr_fir( out, even, mCoeffs.data(), mTaps, n );
+    for ( long i = 0; i < n; i++ ) out[i] = T(0.5) * (out[i] + odd[i]);
+    std::copy( even + n, even + n + span, even );
+    std::copy( odd + n, odd + n + mTaps, odd );
+  }
+
+private:
+  long            mTaps;
+  std::vector<T>  mCoeffs;
+  //! Inputs of each branch, history first
+  std::vector<T>  mUp;
+  std::vector<T>  mEven;
+  std::vector<T>  mOdd;
+  std::vector<T>  mBranch;
+};
+
+//! Runs a block at 2, 4 or 8 times the rate through cascaded halfband
+//  stages. The first stage does most of the work and gets the longest
+//  filter; later ones only remove images well above the audio band.
+//  Stages past the first delay by fractions of a sample, so the outputs
+//  are delayed a few samples more at the higher rate to make up a whole
+//  number of samples at the host's rate
+template<class T>
+class Oversampler {
+public:
+  Oversampler() : mFactor(1), mIns(0), mOuts(0), mPad(0) {}
+
+  //! Main thread. Allocates and clears all state. blockSize is the
+  //  longest block at the host's rate
+  void prepare( int ins, int outs, int factor, long blockSize ) {
+    mFactor = factor;
+    mIns    = ins;
+    mOuts   = outs;
+    auto const stages = this->stages();
+    auto const size   = blockSize * factor;
+    mFilters.assign( (ins + outs) * stages, Halfband<T>() );
+    for ( size_t f = 0; f < mFilters.size(); f++ ) {
+      auto const stage = long(f % stages);
+      mFilters[f].prepare( taps( stage ), blockSize << stage );
+    }
+    mSamples.assign( (ins + outs + 2) * size, T(0) );
+    mChannels.resize( ins + outs + 2 );
+    for ( size_t c = 0; c < mChannels.size(); c++ ) mChannels[c] = mSamples.data() + c * size;
+    long delay = 0;
+    for ( int s = 0; s < stages; s++ ) delay += (2 * taps( s ) - 1) << (stages - 1 - s);
+    // Filter delay in samples at the higher rate is delay * 2
+    mPad = (factor - (2 * delay) % factor) % factor;
+    mPadded.assign( outs * mPad, T(0) );
+  }
+
+  int  factor() const { return mFactor; }
+
+  //! Delay added to the outputs, in samples at the host's rate
+  long latency() const {
+    long delay = 0;
+    for ( int s = 0; s < stages(); s++ ) delay += (2 * taps( s ) - 1) << (stages() - 1 - s);
+    return (2 * delay + mPad) / mFactor;
+  }
+
+  //! Audio thread. Upsamples the inputs, calls process( ins, outs, size )
+  //  at the higher rate and downsamples its outputs into outs
+  template<class Process>
+  void process( T *const *ins, T *const *outs, long size, Process&& process ) {
+    auto const stages  = this->stages();
+    auto const scratch = mChannels.data() + mIns + mOuts;
+    for ( int c = 0; c < mIns; c++ ) {
+      auto filters = &mFilters[c * stages];
+      const T *from = ins[c];
+      for ( int s = 0; s < stages; s++ ) {
+        auto to = (s == stages - 1) ? mChannels[c] : scratch[s & 1];
+        filters[s].up( from, to, size << s );
+        from = to;
+      }
+    }
+    auto const count = size * mFactor;
+    process( mChannels.data(), mChannels.data() + mIns, count );
+    for ( int c = 0; c < mOuts; c++ ) {
+      auto filters = &mFilters[(mIns + c) * stages];
+      const T *from = mChannels[mIns + c];
+      if ( mPad ) {
+        auto out    = mChannels[mIns + c];
+        auto padded = &mPadded[c * mPad];
+        std::swap_ranges( padded, padded + mPad, out + count - mPad );
+        std::rotate( out, out + count - mPad, out + count );
+      }
+      for ( int s = stages - 1; s >= 0; s-- ) {
+        auto to = (s == 0) ? outs[c] : scratch[s & 1];
+        filters[s].down( from, to, size << s );
+        from = to;
+      }
+    }
+  }
+
+private:
+  int         stages() const { return mFactor >= 8 ? 3 : mFactor >= 4 ? 2 : 1; }
+  static long taps( long stage ) { return stage == 0 ? 16 : 8; }
+
+  int                      mFactor;
+  int                      mIns;
+  int                      mOuts;
+  //! Extra delay at the higher rate and the samples it holds back
+  long                     mPad;
+  std::vector<T>           mPadded;
+  //! Stages of each input, then of each output
+  std::vector<Halfband<T>> mFilters;
+  std::vector<T>           mSamples;
+  //! Oversampled inputs and outputs, then two scratch buffers
+  std::vector<T*>          mChannels;
+};
@@ -0,0 +1,274 @@
+//
+//  TRparallel.h
+//  TRextern
+//
+//  Copyright © 2026 Reactify. All rights reserved.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+//! DSP threads per binary for objects running in parallel mode, started
+//  when the first parallel object of any class prepares and shared by all
+//  classes. 0 uses one less than the number of cores
+#ifndef TREXTERN_DSP_THREADS
+#define TREXTERN_DSP_THREADS 0
+#endif
+
+//! Tells the core we're spinning
+inline void tr_cpupause() {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+  _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  __asm__ __volatile__( "yield" );
+#endif
+}
+
+//! One block of work for one object. Whoever claims it first runs it:
+//  a DSP thread, or the audio thread when it needs the result
+class ParallelJob {
+public:
+  enum State { Idle, Queued, Running, Done };
+
+  ParallelJob() : mState(Idle), mQueued(0), mRun(nullptr), mContext(nullptr) {}
+  ParallelJob( const ParallelJob& ) = delete;
+  ParallelJob& operator=( const ParallelJob& ) = delete;
+
+  void setRoutine( void (*run)( void * ), void *context ) {
+    mRun     = run;
+    mContext = context;
+  }
+
+  //! Audio thread. Marks the job ready to be claimed
+  void queue() { mState.store( Queued, std::memory_order_release ); }
+
+  //! Returns false if somebody else claimed the job first
+  bool claim() {
+    int expected = Queued;
+    return mState.compare_exchange_strong( expected, Running, std::memory_order_acq_rel );
+  }
+
+  //! Runs a claimed job
+  void run() {
+    mRun( mContext );
+    mState.store( Done, std::memory_order_release );
+  }
+
+  //! Returns once the job is done, running it here if nobody has started it.
+  //  Spins briefly, then yields
+  void wait() {
+    for ( unsigned spins = 0; ; spins++ ) {
+      auto const state = mState.load( std::memory_order_acquire );
+      if ( state == Idle || state == Done ) return;
+      if ( state == Queued && claim() ) {
+        run();
+        return;
+      }
+      if ( spins < 2048 ) tr_cpupause();
+      else std::this_thread::yield();
+    }
+  }
+
+  //! Main thread. Like wait(), then also waits for queues to let go of
+  //  the job, so it can be destroyed. A job run early stays queued until
+  //  a DSP thread pops it
+  void quiesce() {
+    wait();
+    while ( mQueued.load( std::memory_order_acquire ) > 0 ) std::this_thread::yield();
+  }
+
+  //! Queue bookkeeping. The pop must be the last access to the job
+  void pushed() { mQueued.fetch_add( 1, std::memory_order_relaxed ); }
+  void popped() { mQueued.fetch_sub( 1, std::memory_order_release ); }
+
+private:
+  std::atomic<int> mState;
+  std::atomic<int> mQueued;
+  void (*mRun)( void * );
+  void *mContext;
+};
+
+//! DSP threads shared by the parallel objects in the binary. The audio thread
+//  hands jobs to the threads' queues round robin and idle threads steal
+//  from each other. Submitting never blocks or allocates.
+class DspPool {
+  //! Bounded single-producer/multi-consumer ring
+  struct Queue {
+    static constexpr size_t kCapacity = 64;
+    Queue() : head(0), tail(0) {
+      for ( auto& s : slots ) s.store( nullptr, std::memory_order_relaxed );
+    }
+    bool push( ParallelJob *job ) {
+      auto const t = tail.load( std::memory_order_relaxed );
+      if ( t - head.load( std::memory_order_acquire ) >= kCapacity ) return false;
+      slots[t & (kCapacity - 1)].store( job, std::memory_order_relaxed );
+      tail.store( t + 1, std::memory_order_release );
+      return true;
+    }
+    ParallelJob *pop() {
+      auto h = head.load( std::memory_order_acquire );
+      while ( h < tail.load( std::memory_order_acquire ) ) {
+        auto job = slots[h & (kCapacity - 1)].load( std::memory_order_relaxed );
+        if ( head.compare_exchange_weak( h, h + 1, std::memory_order_acq_rel ) ) return job;
+      }
+      return nullptr;
+    }
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+    std::atomic<ParallelJob*> slots[kCapacity];
+  };
+
+public:
+  explicit DspPool( int threads ) : mQueues( threads > 0 ? threads : 1 ), mNext(0), mSleepers(0), mStop(false) {
+    for ( size_t i = 0; i < mQueues.size(); i++ ) {
+      mThreads.emplace_back( [this, i] { run( i ); } );
+    }
+  }
+
+  ~DspPool() {
+    mStop = true;
+    mWake.notify_all();
+    for ( auto& t : mThreads ) t.join();
+  }
+
+  DspPool( const DspPool& ) = delete;
+  DspPool& operator=( const DspPool& ) = delete;
+
+  static int defaultThreadCount() {
+    if ( TREXTERN_DSP_THREADS > 0 ) return TREXTERN_DSP_THREADS;
+    auto const cores = (int)std::thread::hardware_concurrency();
+    return cores > 1 ? cores - 1 : 1;
+  }
+
+  //! Audio thread. Returns false if every queue is full
+  bool submit( ParallelJob *job ) {
+    job->queue();
+    job->pushed();
+    auto const count = mQueues.size();
+    for ( size_t i = 0; i < count; i++ ) {
+      auto& q = mQueues[(mNext + i) % count];
+      if ( q.push( job ) ) {
+        mNext = (mNext + i + 1) % count;
+        // Only threads that gave up spinning need a syscall to wake
+        if ( mSleepers.load( std::memory_order_acquire ) > 0 ) mWake.notify_one();
+        return true;
+      }
+    }
+    job->popped();
+    return false;
+  }
+
+  size_t threadCount() const { return mThreads.size(); }
+
+private:
+  ParallelJob *take( size_t self ) {
+    auto const count = mQueues.size();
+    for ( size_t i = 0; i < count; i++ ) {
+      if ( auto job = mQueues[(self + i) % count].pop() ) return job;
+    }
+    return nullptr;
+  }
+
+  void run( size_t self ) {
+    unsigned idle = 0;
+    while ( !mStop.load( std::memory_order_relaxed ) ) {
+      if ( auto job = take( self ) ) {
+        idle = 0;
+        if ( job->claim() ) job->run();
+        job->popped();
+        continue;
+      }
+      if ( ++idle < 4096 ) {
+        tr_cpupause();
+        continue;
+      }
+      // Sleep until woken. The timeout covers a wake-up that raced the check
+      std::unique_lock<std::mutex> lock( mLock );
+      mSleepers.fetch_add( 1, std::memory_order_acq_rel );
+      mWake.wait_for( lock, std::chrono::milliseconds(1) );
+      mSleepers.fetch_sub( 1, std::memory_order_acq_rel );
+      idle = 0;
+    }
+  }
+
+  std::vector<Queue>       mQueues;
+  std::vector<std::thread> mThreads;
+  size_t                   mNext;
+  std::atomic<int>         mSleepers;
+  std::atomic<bool>        mStop;
+  std::mutex               mLock;
+  std::condition_variable  mWake;
+};
+
+//! Double buffered signal vectors of a parallel object. The job for one
+//  block works on one half while the audio thread fills the inputs of the
+//  next block and collects the outputs of the previous one from the other
+template<class T>
+class ParallelBuffers {
+public:
+  ParallelBuffers() : mIns(0), mOuts(0), mHalf(0), mSizes{0, 0} {}
+
+  //! Main thread. Allocates and zeroes both halves
+  void prepare( int ins, int outs, long blockSize ) {
+    mIns  = ins;
+    mOuts = outs;
+    mHalf = 0;
+    auto const channels = size_t(ins + outs);
+    mSamples.assign( 2 * channels * blockSize, T(0) );
+    mChannels.resize( 2 * channels );
+    for ( size_t c = 0; c < mChannels.size(); c++ ) {
+      mChannels[c] = mSamples.data() + c * blockSize;
+    }
+    mSizes[0] = mSizes[1] = 0;
+  }
+
+  //! Audio thread. Copies the inputs of the next block into the idle half
+  //  and hands that half to the job
+  void stage( T *const *ins, long size ) {
+    mHalf ^= 1;
+    auto channels = half( mHalf );
+    for ( int i = 0; i < mIns; i++ ) {
+      std::copy( ins[i], ins[i] + size, channels[i] );
+    }
+    mSizes[mHalf] = size;
+  }
+
+  //! Audio thread. Copies the outputs of the previous block. Samples the
+  //  previous block didn't have are zeroed
+  void collect( T *const *outs, long size ) {
+    auto const previous = mHalf ^ 1;
+    auto const channels = half( previous ) + mIns;
+    auto const count    = std::min( mSizes[previous], size );
+    for ( int i = 0; i < mOuts; i++ ) {
+      std::copy( channels[i], channels[i] + count, outs[i] );
+      std::fill( outs[i] + count, outs[i] + size, T(0) );
+    }
+  }
+
+  //! The job's half
+  T**  ins()  { return half( mHalf ); }
+  T**  outs() { return half( mHalf ) + mIns; }
+  long size() const { return mSizes[mHalf]; }
+
+private:
+  T** half( unsigned index ) { return mChannels.data() + index * (mIns + mOuts); }
+
+  int              mIns;
+  int              mOuts;
+  unsigned         mHalf;
+  long             mSizes[2];
+  std::vector<T>   mSamples;
+  std::vector<T*>  mChannels;
+};
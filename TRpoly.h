@@ -0,0 +1,366 @@
+//
+//  TRpoly.h
+//  TRextern
+//
+//  Copyright © 2026 Reactify. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+#include "TRextern.h"
+
+// Voice allocation for polyphonic objects. Voice state is kept as one array
+// per field (pitch, phase, envelope...) with the sounding voices packed at
+// the front, so process() renders every active voice in one loop over
+// plain arrays and idle voices cost nothing:
+//
+//   mVoices.beginBlock();
+//   for ( auto v : mVoices.started() ) phase[v] = 0;
+//   for ( long i = 0; i < size; i++ ) {
+//     t_sample sum = 0;
+//     for ( size_t v = 0; v < mVoices.active(); v++ ) sum += ...;
+//     out[i] = sum;
+//   }
+//   mVoices.endBlock();
+
+//! Which voice a note takes when all voices are busy. Voices already
+//  released are always taken before ones still held
+enum class VoiceSteal {
+  None,     //!< Drop the note
+  Oldest,   //!< Voice started first
+  Quietest, //!< Voice with the lowest level()
+  Lowest,   //!< Voice with the lowest pitch
+  Highest   //!< Voice with the highest pitch
+};
+
+class VoicePool;
+
+//! Handle to a column of per-voice state added with VoicePool::addColumn()
+template<class T>
+class VoiceColumn {
+public:
+  VoiceColumn() : mPool(nullptr), mIndex(0) {}
+  VoiceColumn( VoicePool *pool, size_t index ) : mPool(pool), mIndex(index) {}
+
+  //! One value per voice, active voices first
+  T*   data() const;
+  T&   operator[]( size_t voice ) const { return data()[voice]; }
+
+private:
+  VoicePool *mPool;
+  size_t     mIndex;
+};
+
+class VoicePool : NonCopyable {
+public:
+  explicit VoicePool( size_t voices, VoiceSteal steal = VoiceSteal::Oldest );
+
+  //! Adds a column of per-voice state, set to initial for every voice.
+  //  Call from setup()
+  template<class T>
+  VoiceColumn<T> addColumn( T initial = T() );
+
+  void       setSteal( VoiceSteal steal ) { mSteal = steal; }
+  size_t     capacity() const { return mCapacity; }
+
+  //! Control side. Queue notes for the next block; a velocity of 0 or
+  //  less releases the note. Return false if the queue is full. In Max,
+  //  the main and scheduler threads take turns
+  bool       noteOn ( t_sample pitch, t_sample velocity );
+  bool       noteOff( t_sample pitch ) { return noteOn( pitch, 0 ); }
+  //! Releases every held voice
+  bool       allNotesOff();
+  //! Takes a list of pitch/velocity pairs, e.g. from listReceived(). Returns
+  //  false if the list isn't made of number pairs
+  bool       receive( AtomSpan atoms );
+
+  //! Audio side. Applies the queued notes. started() and released() list
+  //  the voices that changed, valid until endBlock()
+  void       beginBlock();
+  //! Frees the voices passed to finish() during the block
+  void       endBlock();
+  //! Marks a voice as silent, e.g. when its envelope has ended. It keeps
+  //  its place until endBlock(), so the loop over active() isn't disturbed
+  void       finish( size_t voice );
+  //! Frees every voice, e.g. from prepare()
+  void       reset();
+
+  //! Number of sounding voices. Their state is at [0, active())
+  size_t     active() const { return mActive; }
+  //! Voices that took a note this block, new or stolen. Reset their state
+  const std::vector<size_t>& started()  const { return mStarted; }
+  //! Voices whose note was released this block. Listed after started()
+  //  when both happen in one block
+  const std::vector<size_t>& released() const { return mReleased; }
+
+  const t_sample* pitch()    const { return mPitch.data(); }
+  const t_sample* velocity() const { return mVelocity.data(); }
+  //! 1 while the note is held, 0 once released
+  const t_sample* gate()     const { return mGate.data(); }
+  //! Written by process(), e.g. with the envelope, for VoiceSteal::Quietest
+  t_sample*       level()    const { return mLevel.data(); }
+
+  // Do not call. Used by VoiceColumn
+  void*           columnData( size_t index ) const { return mColumns[index]->data; }
+
+private:
+  struct ColumnBase {
+    virtual ~ColumnBase() {}
+    virtual void move ( size_t from, size_t to ) = 0;
+    virtual void clear( size_t voice ) = 0;
+    void *data = nullptr;
+  };
+
+  template<class T>
+  struct Column : ColumnBase {
+    Column( size_t size, T initial ) : values(size, initial), initial(initial) { data = values.data(); }
+    void move ( size_t from, size_t to ) override { values[to] = values[from]; }
+    void clear( size_t voice ) override { values[voice] = initial; }
+    std::vector<T> values;
+    T              initial;
+  };
+
+  struct Event {
+    enum Type : uint8_t { Note, AllOff } type;
+    t_sample pitch;
+    t_sample velocity;
+  };
+
+  void       start  ( t_sample pitch, t_sample velocity );
+  void       release( t_sample pitch );
+  void       release( size_t voice );
+  //! Takes a voice off released() in constant time
+  void       unrelease( size_t voice );
+  void       clearChanges();
+  long       victim () const;
+
+  size_t     mCapacity;
+  VoiceSteal mSteal;
+  size_t     mActive;
+  uint64_t   mNotes;
+  bool       mFinished;
+  std::vector<std::unique_ptr<ColumnBase>> mColumns;
+  VoiceColumn<t_sample> mPitch;
+  VoiceColumn<t_sample> mVelocity;
+  VoiceColumn<t_sample> mGate;
+  VoiceColumn<t_sample> mLevel;
+  //! Note number each voice started with, for VoiceSteal::Oldest
+  VoiceColumn<uint64_t> mOrder;
+  VoiceColumn<uint8_t>  mDone;
+  std::vector<size_t>   mStarted;
+  std::vector<size_t>   mReleased;
+  //! Per voice, whether it is in mStarted and its place in mReleased plus
+  //  one, or 0. Indexed by the same slots as the lists, so unlike columns
+  //  they aren't moved by endBlock()
+  std::vector<uint8_t>  mIsStarted;
+  std::vector<size_t>   mReleasedAt;
+  SpscQueue<Event, 256> mEvents;
+#ifndef PD
+  //! Max queues notes from the main and the scheduler thread
+  SpinLock              mPushLock;
+#endif
+
+  bool       queue( Event const& event );
+};
+
+//------------------------------------------------------------------------------
+template<class T>
+T* VoiceColumn<T>::data() const {
+  return static_cast<T *>( mPool->columnData( mIndex ) );
+}
+
+//------------------------------------------------------------------------------
+inline VoicePool::VoicePool( size_t voices, VoiceSteal steal )
+: mCapacity(voices), mSteal(steal), mActive(0), mNotes(0), mFinished(false) {
+  mPitch    = addColumn<t_sample>( 0 );
+  mVelocity = addColumn<t_sample>( 0 );
+  mGate     = addColumn<t_sample>( 0 );
+  mLevel    = addColumn<t_sample>( 0 );
+  mOrder    = addColumn<uint64_t>( 0 );
+  mDone     = addColumn<uint8_t>( 0 );
+  mStarted.reserve( voices );
+  mReleased.reserve( voices );
+  mIsStarted.assign( voices, 0 );
+  mReleasedAt.assign( voices, 0 );
+}
+
+//------------------------------------------------------------------------------
+template<class T>
+VoiceColumn<T> VoicePool::addColumn( T initial ) {
+  static_assert( std::is_trivially_copyable<T>::value, "Voice state must be plain data" );
+  mColumns.emplace_back( new Column<T>( mCapacity, initial ) );
+  return VoiceColumn<T>( this, mColumns.size() - 1 );
+}
+
+//------------------------------------------------------------------------------
+inline bool VoicePool::noteOn( t_sample pitch, t_sample velocity ) {
+  return queue( { Event::Note, pitch, velocity } );
+}
+
+//------------------------------------------------------------------------------
+inline bool VoicePool::allNotesOff() {
+  return queue( { Event::AllOff, 0, 0 } );
+}
+
+//------------------------------------------------------------------------------
+inline bool VoicePool::queue( Event const& event ) {
+#ifndef PD
+  std::lock_guard<SpinLock> guard( mPushLock );
+#endif
+  return mEvents.push( event );
+}
+
+//------------------------------------------------------------------------------
+inline bool VoicePool::receive( AtomSpan atoms ) {
+  if ( atoms.empty() || atoms.size() % 2 ) return false;
+  for ( size_t i = 0; i < atoms.size(); i++ ) {
+    if ( !atoms.isNumber( i ) ) return false;
+  }
+  for ( size_t i = 0; i < atoms.size(); i += 2 ) {
+    if ( !noteOn( atoms.getFloat( i ), atoms.getFloat( i + 1 ) ) ) return false;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+inline void VoicePool::beginBlock() {
+  clearChanges();
+  Event event;
+  while ( mEvents.pop( event ) ) {
+    if ( event.type == Event::AllOff ) {
+      for ( size_t v = 0; v < mActive; v++ ) release( v );
+    } else if ( event.velocity > 0 ) {
+      start( event.pitch, event.velocity );
+    } else {
+      release( event.pitch );
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+inline void VoicePool::endBlock() {
+  if ( !mFinished ) return;
+  mFinished = false;
+  auto const done = mDone.data();
+  // Walking down, the voice moved into a freed slot has been checked already
+  for ( size_t v = mActive; v-- > 0; ) {
+    if ( !done[v] ) continue;
+    auto const last = --mActive;
+    for ( auto& column : mColumns ) {
+      if ( v != last ) column->move( last, v );
+      column->clear( last );
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+inline void VoicePool::finish( size_t voice ) {
+  if ( voice >= mActive ) return;
+  mDone[voice] = 1;
+  mFinished    = true;
+}
+
+//------------------------------------------------------------------------------
+inline void VoicePool::reset() {
+  for ( size_t v = 0; v < mActive; v++ ) {
+    for ( auto& column : mColumns ) column->clear( v );
+  }
+  mActive   = 0;
+  mFinished = false;
+  clearChanges();
+}
+
+//------------------------------------------------------------------------------
+inline void VoicePool::start( t_sample pitch, t_sample velocity ) {
+  size_t voice = mActive;
+  if ( mActive < mCapacity ) {
+    mActive++;
+  } else {
+    auto const stolen = victim();
+    if ( stolen < 0 ) return;
+    voice = (size_t)stolen;
+    for ( auto& column : mColumns ) column->clear( voice );
+    // A voice stolen after its release this block starts over
+    unrelease( voice );
+  }
+  mPitch[voice]    = pitch;
+  mVelocity[voice] = velocity;
+  mGate[voice]     = 1;
+  mOrder[voice]    = ++mNotes;
+  if ( !mIsStarted[voice] ) {
+    mIsStarted[voice] = 1;
+    mStarted.push_back( voice );
+  }
+}
+
+//------------------------------------------------------------------------------
+inline void VoicePool::release( t_sample pitch ) {
+  // The oldest held voice playing the pitch, as repeated notes stack
+  auto const gate  = mGate.data();
+  auto const order = mOrder.data();
+  long voice = -1;
+  for ( size_t v = 0; v < mActive; v++ ) {
+    if ( gate[v] > 0 && mPitch[v] == pitch && (voice < 0 || order[v] < order[voice]) ) {
+      voice = (long)v;
+    }
+  }
+  if ( voice >= 0 ) release( (size_t)voice );
+}
+
+//------------------------------------------------------------------------------
+inline void VoicePool::release( size_t voice ) {
+  if ( mGate[voice] <= 0 ) return;
+  mGate[voice] = 0;
+  mReleased.push_back( voice );
+  mReleasedAt[voice] = mReleased.size();
+}
+
+//------------------------------------------------------------------------------
+inline void VoicePool::unrelease( size_t voice ) {
+  auto const at = mReleasedAt[voice];
+  if ( !at ) return;
+  // Swap with the last entry, like endBlock() does with voices
+  auto const last = mReleased.back();
+  mReleased[at - 1]  = last;
+  mReleasedAt[last]  = at;
+  mReleased.pop_back();
+  mReleasedAt[voice] = 0;
+}
+
+//------------------------------------------------------------------------------
+inline void VoicePool::clearChanges() {
+  for ( auto v : mStarted )  mIsStarted[v]  = 0;
+  for ( auto v : mReleased ) mReleasedAt[v] = 0;
+  mStarted.clear();
+  mReleased.clear();
+}
+
+//------------------------------------------------------------------------------
+inline long VoicePool::victim() const {
+  if ( mSteal == VoiceSteal::None || mActive == 0 ) return -1;
+  auto const gate  = mGate.data();
+  auto const order = mOrder.data();
+  auto const level = mLevel.data();
+  auto const pitch = mPitch.data();
+  // True if voice a makes a better victim than voice b
+  auto better = [&]( size_t a, size_t b ) {
+    if ( (gate[a] > 0) != (gate[b] > 0) ) return gate[a] <= 0;
+    switch ( mSteal ) {
+      case VoiceSteal::Quietest: if ( level[a] != level[b] ) return level[a] < level[b]; break;
+      case VoiceSteal::Lowest:   if ( pitch[a] != pitch[b] ) return pitch[a] < pitch[b]; break;
+      case VoiceSteal::Highest:  if ( pitch[a] != pitch[b] ) return pitch[a] > pitch[b]; break;
+      default: break;
+    }
+    return order[a] < order[b];
+  };
+  size_t voice = 0;
+  for ( size_t v = 1; v < mActive; v++ ) {
+    if ( better( v, voice ) ) voice = v;
+  }
+  return (long)voice;
+}
@@ -0,0 +1,177 @@
+//
+//  TRprofile.h
+//  TRextern
+//
+//  Copyright © 2026 Reactify. All rights reserved.
+//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define TR_PROFILE_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TR_PROFILE_TSC 1
+#endif
+
+//! Cheapest monotonic counter available. The time stamp counter on x86,
+//  the virtual counter on AArch64 and steady_clock elsewhere
+inline uint64_t tr_ticks() {
+#if defined(TR_PROFILE_TSC)
+  return __rdtsc();
+#elif defined(__aarch64__)
+  uint64_t value;
+  __asm__ __volatile__( "mrs %0, cntvct_el0" : "=r"(value) );
+  return value;
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch() ).count();
+#endif
+}
+
+//! Rate of tr_ticks(). Measured against steady_clock the first time it is
+//  called on x86, which takes a few milliseconds
+inline double tr_tickspersecond() {
+#if defined(TR_PROFILE_TSC)
+  static double const rate = [] {
+    using clock = std::chrono::steady_clock;
+    auto const start = clock::now();
+    auto const ticks = tr_ticks();
+    while ( clock::now() - start < std::chrono::milliseconds(5) ) {}
+    auto const elapsed = std::chrono::duration<double>( clock::now() - start ).count();
+    return double(tr_ticks() - ticks) / elapsed;
+  }();
+  return rate;
+#elif defined(__aarch64__)
+  uint64_t value;
+  __asm__ __volatile__( "mrs %0, cntfrq_el0" : "=r"(value) );
+  return double(value);
+#else
+  return 1e9;
+#endif
+}
+
+//! Summary of a DspProfile. Times are in microseconds
+struct ProfileStats {
+  uint64_t blocks;
+  uint64_t overruns;
+  double   min;
+  double   mean;
+  double   max;
+  double   p99;
+  //! Mean share of the block period spent in process(), in percent
+  double   load;
+};
+
+//! Per-object timing of process(). The audio thread records one entry per
+//  block; any other thread can take a snapshot or ask for a reset at the
+//  same time without locking. Durations go into a histogram with four
+//  buckets per power of two, so percentiles are accurate to about 20%.
+class DspProfile {
+public:
+  static constexpr int kSubBuckets = 4;
+  static constexpr int kBuckets    = 64 * kSubBuckets;
+
+  DspProfile() : mTicksPerSample(0), mSecondsPerTick(0), mBlockTicks(0) { clear(); }
+  DspProfile( const DspProfile& ) = delete;
+  DspProfile& operator=( const DspProfile& ) = delete;
+
+  //! Main thread. Call whenever DSP is (re)started
+  void prepare( double sampleRate, long blockSize ) {
+    auto const rate = tr_tickspersecond();
+    mSecondsPerTick = 1.0 / rate;
+    mTicksPerSample = sampleRate > 0 ? rate / sampleRate : 0;
+    mBlockTicks     = mTicksPerSample * blockSize;
+  }
+
+  //! Audio thread. Adds a block of size samples that took ticks
+  void record( uint64_t ticks, long size ) {
+    if ( mResetRequested.load( std::memory_order_acquire ) ) {
+      clear();
+      mResetRequested.store( false, std::memory_order_release );
+    }
+    // Single writer, so plain load/store is enough
+    auto bump = []( std::atomic<uint64_t>& a, uint64_t v ) {
+      a.store( a.load( std::memory_order_relaxed ) + v, std::memory_order_relaxed );
+    };
+    bump( mBuckets[bucket( ticks )], 1 );
+    bump( mTicks, ticks );
+    if ( ticks < mMin.load( std::memory_order_relaxed ) ) mMin.store( ticks, std::memory_order_relaxed );
+    if ( ticks > mMax.load( std::memory_order_relaxed ) ) mMax.store( ticks, std::memory_order_relaxed );
+    if ( ticks > mTicksPerSample * size ) bump( mOverruns, 1 );
+    // Published last so a reader never sees more blocks than samples
+    mBlocks.store( mBlocks.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+  }
+
+  //! Any thread. Statistics gathered so far
+  ProfileStats stats() const {
+    ProfileStats s{};
+    s.blocks = mBlocks.load( std::memory_order_acquire );
+    if ( s.blocks == 0 ) return s;
+    auto const us = mSecondsPerTick * 1e6;
+    s.overruns = mOverruns.load( std::memory_order_relaxed );
+    s.min  = mMin.load( std::memory_order_relaxed ) * us;
+    s.max  = mMax.load( std::memory_order_relaxed ) * us;
+    auto const mean = double(mTicks.load( std::memory_order_relaxed )) / s.blocks;
+    s.mean = mean * us;
+    s.load = mBlockTicks > 0 ? 100.0 * mean / mBlockTicks : 0;
+
+    // Upper edge of the bucket holding the 99th percentile
+    auto const target = s.blocks - s.blocks / 100;
+    uint64_t seen = 0;
+    for ( auto i = 0; i < kBuckets; i++ ) {
+      seen += mBuckets[i].load( std::memory_order_relaxed );
+      if ( seen >= target ) {
+        s.p99 = double(upperEdge( i )) * us;
+        break;
+      }
+    }
+    if ( s.p99 > s.max ) s.p99 = s.max;
+    return s;
+  }
+
+  //! Any thread. Cleared before the next block is recorded
+  void reset() { mResetRequested.store( true, std::memory_order_release ); }
+
+private:
+  static int bucket( uint64_t ticks ) {
+    if ( ticks < kSubBuckets ) return int(ticks);
+    int msb = 63;
+    while ( !(ticks >> msb) ) msb--;
+    auto const sub = int(ticks >> (msb - 2)) & (kSubBuckets - 1);
+    return (msb - 1) * kSubBuckets + sub;
+  }
+
+  static uint64_t upperEdge( int index ) {
+    if ( index < kSubBuckets ) return uint64_t(index);
+    auto const msb = index / kSubBuckets + 1;
+    auto const sub = uint64_t(index % kSubBuckets);
+    return ((kSubBuckets + sub + 1) << (msb - 2)) - 1;
+  }
+
+  void clear() {
+    for ( auto& b : mBuckets ) b.store( 0, std::memory_order_relaxed );
+    mTicks.store( 0, std::memory_order_relaxed );
+    mMin.store( UINT64_MAX, std::memory_order_relaxed );
+    mMax.store( 0, std::memory_order_relaxed );
+    mOverruns.store( 0, std::memory_order_relaxed );
+    mBlocks.store( 0, std::memory_order_release );
+    mResetRequested.store( false, std::memory_order_relaxed );
+  }
+
+  double                mTicksPerSample;
+  double                mSecondsPerTick;
+  double                mBlockTicks;
+  std::atomic<uint64_t> mBlocks;
+  std::atomic<uint64_t> mTicks;
+  std::atomic<uint64_t> mMin;
+  std::atomic<uint64_t> mMax;
+  std::atomic<uint64_t> mOverruns;
+  std::atomic<bool>     mResetRequested;
+  std::atomic<uint64_t> mBuckets[kBuckets];
+};
@@ -0,0 +1,137 @@
+//
+//  TRqueue.h
+//  TRextern
+//
+//  Copyright © 2026 Reactify. All rights reserved.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <utility>
+
+//! Fixed size single-producer/single-consumer queue. Lock- and allocation
+//  free, so it can be used to pass data between the control and audio side.
+//  Capacity must be a power of two.
+template<class T, size_t Capacity>
+class SpscQueue {
+  static_assert( Capacity && !(Capacity & (Capacity - 1)), "Capacity must be a power of two" );
+public:
+  SpscQueue() : mHead(0), mTail(0) {}
+  SpscQueue( const SpscQueue& ) = delete;
+  SpscQueue& operator=( const SpscQueue& ) = delete;
+
+  //! Producer side. Returns false if the queue is full
+  bool push( const T& value ) {
+    auto const tail = mTail.load( std::memory_order_relaxed );
+    if ( tail - mHead.load( std::memory_order_acquire ) == Capacity ) return false;
+    mBuffer[tail & (Capacity - 1)] = value;
+    mTail.store( tail + 1, std::memory_order_release );
+    return true;
+  }
+
+  //! Consumer side. Returns false if the queue is empty
+  bool pop( T& value ) {
+    auto const head = mHead.load( std::memory_order_relaxed );
+    if ( head == mTail.load( std::memory_order_acquire ) ) return false;
+    value = mBuffer[head & (Capacity - 1)];
+    mHead.store( head + 1, std::memory_order_release );
+    return true;
+  }
+
+  //! Consumer side. Points at the next element without removing it
+  const T* peek() const {
+    auto const head = mHead.load( std::memory_order_relaxed );
+    if ( head == mTail.load( std::memory_order_acquire ) ) return nullptr;
+    return &mBuffer[head & (Capacity - 1)];
+  }
+
+  bool   empty() const { return size() == 0; }
+  size_t size()  const {
+    return mTail.load( std::memory_order_acquire ) - mHead.load( std::memory_order_acquire );
+  }
+
+  static constexpr size_t capacity() { return Capacity; }
+
+private:
+  // Keep producer and consumer indices on separate cache lines
+  std::atomic<size_t> mHead;
+  char                mPadHead[64 - sizeof(std::atomic<size_t>)];
+  std::atomic<size_t> mTail;
+  char                mPadTail[64 - sizeof(std::atomic<size_t>)];
+  T                   mBuffer[Capacity];
+};
+
+//! Unbounded multi-producer/single-consumer queue. push and consume are lock
+//  free, but push allocates a node, so don't use it from the audio thread.
+template<class T>
+class MpscQueue {
+  struct Node {
+    T     value;
+    Node *next;
+  };
+public:
+  MpscQueue() : mHead(nullptr) {}
+  MpscQueue( const MpscQueue& ) = delete;
+  MpscQueue& operator=( const MpscQueue& ) = delete;
+  ~MpscQueue() { consume( []( T&& ) {} ); }
+
+  //! Any thread
+  void push( T value ) {
+    auto node = new Node{ std::move( value ), mHead.load( std::memory_order_relaxed ) };
+    while ( !mHead.compare_exchange_weak( node->next, node,
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed ) ) {}
+  }
+
+  //! Consumer side. Calls fn with every element pushed so far, oldest first.
+  //  Returns the number of elements consumed
+  template<class Fn>
+  size_t consume( Fn&& fn ) {
+    // Take the whole stack at once and reverse it into push order
+    Node *node = mHead.exchange( nullptr, std::memory_order_acquire );
+    Node *ordered = nullptr;
+    while ( node ) {
+      auto next  = node->next;
+      node->next = ordered;
+      ordered    = node;
+      node       = next;
+    }
+    size_t count = 0;
+    while ( ordered ) {
+      auto next = ordered->next;
+      fn( std::move( ordered->value ) );
+      delete ordered;
+      ordered = next;
+      count++;
+    }
+    return count;
+  }
+
+  bool empty() const { return mHead.load( std::memory_order_acquire ) == nullptr; }
+
+private:
+  std::atomic<Node*> mHead;
+};
+
+//! Lock for producers taking turns at the producer side of an SpscQueue,
+//  e.g. Max's main and scheduler threads. Only held for a push, so it
+//  spins, then yields. Never take it on the audio thread
+class SpinLock {
+public:
+  SpinLock() { mFlag.clear(); }
+  SpinLock( const SpinLock& ) = delete;
+  SpinLock& operator=( const SpinLock& ) = delete;
+
+  void lock() {
+    for ( unsigned spins = 0; mFlag.test_and_set( std::memory_order_acquire ); spins++ ) {
+      if ( spins >= 64 ) std::this_thread::yield();
+    }
+  }
+  void unlock() { mFlag.clear( std::memory_order_release ); }
+
+private:
+  std::atomic_flag mFlag;
+};
@@ -0,0 +1,103 @@
+//
+//  TRworker.h
+//  TRextern
+//
+//  Copyright © 2026 Reactify. All rights reserved.
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+//! Number of worker threads per binary, started when the first class
+//  initialises and shared by every class in it. Define before including
+//  TRextern.h to change. 0 runs deferred work on the calling thread
+#ifndef TREXTERN_WORKER_THREADS
+#define TREXTERN_WORKER_THREADS 2
+#endif
+
+//! Type erased, move-only unit of work
+class DeferTask {
+public:
+  virtual ~DeferTask() {}
+  virtual void run() = 0;
+};
+
+template<class Fn>
+class DeferTaskImpl : public DeferTask {
+public:
+  explicit DeferTaskImpl( Fn fn ) : mFn( std::move( fn ) ) {}
+  void run() override { mFn(); }
+private:
+  Fn mFn;
+};
+
+template<class Fn>
+std::unique_ptr<DeferTask> tr_makedefertask( Fn&& fn ) {
+  using F = typename std::decay<Fn>::type;
+  return std::unique_ptr<DeferTask>( new DeferTaskImpl<F>( std::forward<Fn>( fn ) ) );
+}
+
+//! Fixed set of threads running tasks in the order they were pushed.
+//  For non-realtime work only: push takes a lock and allocates
+class WorkerPool {
+public:
+  explicit WorkerPool( int threads ) : mStop(false) {
+    for ( auto i = 0; i < threads; i++ ) {
+      mThreads.emplace_back( [this] { run(); } );
+    }
+  }
+
+  ~WorkerPool() {
+    {
+      std::lock_guard<std::mutex> guard( mLock );
+      mStop = true;
+    }
+    mWake.notify_all();
+    for ( auto& t : mThreads ) t.join();
+  }
+
+  WorkerPool( const WorkerPool& ) = delete;
+  WorkerPool& operator=( const WorkerPool& ) = delete;
+
+  void push( std::unique_ptr<DeferTask> task ) {
+    if ( mThreads.empty() ) {
+      task->run();
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> guard( mLock );
+      mTasks.push_back( std::move( task ) );
+    }
+    mWake.notify_one();
+  }
+
+  size_t threadCount() const { return mThreads.size(); }
+
+private:
+  void run() {
+    for ( ;; ) {
+      std::unique_ptr<DeferTask> task;
+      {
+        std::unique_lock<std::mutex> lock( mLock );
+        mWake.wait( lock, [this] { return mStop || !mTasks.empty(); } );
+        if ( mTasks.empty() ) return;
+        task = std::move( mTasks.front() );
+        mTasks.pop_front();
+      }
+      task->run();
+    }
+  }
+
+  std::mutex                             mLock;
+  std::condition_variable                mWake;
+  std::deque<std::unique_ptr<DeferTask>> mTasks;
+  std::vector<std::thread>               mThreads;
+  bool                                   mStop;
+};
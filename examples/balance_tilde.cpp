@@ -10,8 +10,9 @@
 // http://pdstatic.iem.at/externals-HOWTO/pd-externals-HOWTOse5.html#x7-290005
 
 #include "TRextern.h"
+#include "TRkernels.h"
 
-class balance_tilde : public TRextern {
+class balance_tilde : public TRexternStatic<balance_tilde> {
 public:
   void  setup( int argc, t_atom *argv ) override;
   void  exit() override;
@@ -23,20 +24,22 @@ public:
   
   void  process( t_sample **const inChannels, t_sample **const outChannels, long size ) override;
 
-  t_sample mBalance;
+  Parameter* mBalance;
 };
 
 //------------------------------------------------------------------------------
 void balance_tilde::setup( int argc, t_atom *argv ) {
+  t_sample balance = 0.f;
   if ( argc == 1 ) {
-    mBalance = atom_getfloat( argv );
-  } else {
-    mBalance = 0.f;
+    balance = atom_getfloat( argv );
   }
 
   // Set up all inlets and outlets here
   setupIO(2, 1);
-  addInletFloat("balance");
+  // Balance takes a signal or floats. Float changes ramp over 20ms
+  // to avoid zipper noise
+  mBalance = &addInletParameter("balance", balance, 20);
+  mBalance->setRange(0, 1);
 }
 
 //------------------------------------------------------------------------------
@@ -57,7 +60,6 @@ void balance_tilde::intReceived( InletRef inlet, long value ) {
 //------------------------------------------------------------------------------
 void balance_tilde::floatReceived( InletRef inlet, t_sample value ) {
   post("Float received: %s = %f", inlet->getId().c_str(), value );
-  mBalance = value;
 }
 
 //------------------------------------------------------------------------------
@@ -70,10 +72,13 @@ void balance_tilde::process( t_sample **const inBuffers, t_sample **const outBuf
   t_sample *in1 = inBuffers[0];
   t_sample *in2 = inBuffers[1];
   t_sample *out = outBuffers[0];
-  long      n   = size;
-  t_sample  balance = (mBalance<0)?0.0:(mBalance>1)?1.0:mBalance;
 
-  while (n--) *out++ = (*in1++)*(1-balance)+(*in2++)*balance;
+  // A connected signal is never constant
+  if ( mBalance->isConstant() ) {
+    tr_crossfade( out, in1, in2, mBalance->value(), size );
+  } else {
+    tr_crossfade( out, in1, in2, mBalance->values(), size );
+  }
 }
 
 TREXTERN_CREATE(balance_tilde)
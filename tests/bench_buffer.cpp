@@ -0,0 +1,135 @@
+//
+//  bench_buffer.cpp
+//  TRextern
+//
+//  Copyright © 2026 Reactify. All rights reserved.
+//
+
+// Loading a 10 second stereo WAV file through BufferCache from 1 and from
+// 8 threads at once, as 16 bit integers, which are decoded, and as 32 bit
+// floats, which are mapped. Each thread reads every sample once after it
+// has the buffer. Every case runs in a child process of its own, so the
+// peak resident memory it reports is its own. However many threads ask,
+// the file is loaded once, so time and memory should barely change with
+// the number of threads
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "TRbuffer.h"
+
+static const int    kFrames   = 480000;
+static const int    kChannels = 2;
+static const double kRate     = 48000;
+
+//------------------------------------------------------------------------------
+static void writeLE( std::FILE *file, uint64_t value, int bytes ) {
+  for ( int i = 0; i < bytes; i++ ) std::fputc( int(value >> (8 * i)) & 0xff, file );
+}
+
+//! A sine, stored as 16 bit integers (encoding 1) or 32 bit floats (3)
+static void writeWav( std::string const& path, int encoding, int bits ) {
+  auto const file = std::fopen( path.c_str(), "wb" );
+  auto const bytes = uint64_t(kFrames) * kChannels * (bits / 8);
+  std::fwrite( "RIFF", 1, 4, file ); writeLE( file, 4 + 24 + 8 + bytes, 4 );
+  std::fwrite( "WAVE", 1, 4, file );
+  std::fwrite( "fmt ", 1, 4, file ); writeLE( file, 16, 4 );
+  writeLE( file, encoding, 2 ); writeLE( file, kChannels, 2 ); writeLE( file, (uint64_t)kRate, 4 );
+  writeLE( file, (uint64_t)kRate * kChannels * (bits / 8), 4 );
+  writeLE( file, kChannels * (bits / 8), 2 ); writeLE( file, bits, 2 );
+  std::fwrite( "data", 1, 4, file ); writeLE( file, bytes, 4 );
+  for ( int i = 0; i < kFrames * kChannels; i++ ) {
+    auto const x = 0.5 * std::sin( i * 0.01 );
+    if ( encoding == 3 ) {
+      float f = (float)x;
+      uint32_t u;
+      std::memcpy( &u, &f, 4 );
+      writeLE( file, u, 4 );
+    } else {
+      writeLE( file, (uint64_t)(int64_t)std::lround( x * 32767 ), 2 );
+    }
+  }
+  std::fclose( file );
+}
+
+//! Peak resident memory of this process in KiB
+static long peakKiB() {
+  rusage usage;
+  getrusage( RUSAGE_SELF, &usage );
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+}
+
+//------------------------------------------------------------------------------
+//! Loads path from a number of threads and prints the time until all of
+//  them have read it and how far that raised peak memory
+static bool measure( std::string const& name, std::string const& path, int threads ) {
+  auto const before = peakKiB();
+  std::atomic<int> failures( 0 );
+  std::vector<double> sums( threads );
+  std::vector<BufferRef> buffers( threads );
+  auto const start = std::chrono::steady_clock::now();
+  std::vector<std::thread> pool;
+  for ( int t = 0; t < threads; t++ ) {
+    pool.emplace_back( [&, t] {
+      std::string error;
+      buffers[t] = BufferCache::instance().acquire( path, &error );
+      if ( !buffers[t] ) {
+        std::fprintf( stderr, "bench_buffer: %s\n", error.c_str() );
+        failures++;
+        return;
+      }
+      auto const view = buffers[t]->view();
+      double total = 0;
+      for ( size_t i = 0; i < view.frames * view.channels; i++ ) total += view.data[i];
+      sums[t] = total;
+    } );
+  }
+  for ( auto& thread : pool ) thread.join();
+  auto const ms = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+  bool shared = true;
+  for ( auto& buffer : buffers ) shared = shared && buffer == buffers[0];
+  std::printf( "%-10s %8d %10.2f %12ld %8s\n", name.c_str(), threads, ms, peakKiB() - before,
+               shared ? "yes" : "no" );
+  return failures == 0 && shared;
+}
+
+//------------------------------------------------------------------------------
+int main() {
+  auto const dir = std::string( P_tmpdir );
+  auto const int16 = dir + "/bench_buffer_int16.wav";
+  auto const float32 = dir + "/bench_buffer_float32.wav";
+  writeWav( int16, 1, 16 );
+  writeWav( float32, 3, 32 );
+
+  std::printf( "%-10s %8s %10s %12s %8s\n", "file", "threads", "ms", "peak +KiB", "shared" );
+  int failures = 0;
+  for ( auto const& file : { std::make_pair( "int16", int16 ), std::make_pair( "float32", float32 ) } ) {
+    for ( int threads : { 1, 8 } ) {
+      std::fflush( stdout );
+      auto const child = fork();
+      if ( child == 0 ) {
+        auto const ok = measure( file.first, file.second, threads );
+        std::fflush( stdout );
+        _exit( ok ? 0 : 1 );
+      }
+      int status = 0;
+      waitpid( child, &status, 0 );
+      if ( !WIFEXITED( status ) || WEXITSTATUS( status ) != 0 ) failures++;
+    }
+  }
+  std::remove( int16.c_str() );
+  std::remove( float32.c_str() );
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,71 @@
+//
+//  bench_dispatch.cpp
+//  TRextern
+//
+//  Copyright © 2026 Reactify. All rights reserved.
+//
+
+// Virtual against static dispatch: the same gain object derived from
+// TRextern and from TRexternStatic, timed per block and per message
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include "TRextern.h"
+
+static const int  kObjects  = 256;
+static const long kBlocks   = 2000;
+static const long kMessages = 1000000;
+
+//! The work both objects do
+static inline void gain( t_sample *out, const t_sample *in, t_sample g, long size ) {
+  for ( long i = 0; i < size; i++ ) out[i] = in[i] * g;
+}
+
+class gain_virtual_tilde : public TRextern {
+public:
+  void  setup( int, t_atom * ) override { setupIO( 1, 1 ); addInletFloat( "gain" ); }
+  void  floatReceived( InletRef, t_sample value ) override { mGain = value; }
+  void  process( t_sample **const ins, t_sample **const outs, long size ) override {
+    gain( outs[0], ins[0], mGain, size );
+  }
+  t_sample mGain = 1;
+};
+
+class gain_static_tilde : public TRexternStatic<gain_static_tilde> {
+public:
+  void  setup( int, t_atom * ) override { setupIO( 1, 1 ); addInletFloat( "gain" ); }
+  void  floatReceived( InletRef, t_sample value ) override { mGain = value; }
+  void  process( t_sample **const ins, t_sample **const outs, long size ) override {
+    gain( outs[0], ins[0], mGain, size );
+  }
+  t_sample mGain = 1;
+};
+
+TREXTERN_CREATE(gain_virtual_tilde)
+TREXTERN_CREATE(gain_static_tilde)
+
+//------------------------------------------------------------------------------
+static void measure( const char *name ) {
+  auto& host = OfflineHost::instance();
+  std::vector<std::unique_ptr<OfflineObject>> objects;
+  for ( int i = 0; i < kObjects; i++ ) objects.emplace_back( new OfflineObject( name ) );
+  host.startDsp();
+  host.tick( 10 );
+  auto const block = tr_offlinemeasure( kBlocks, [&] { host.tick(); } ) / kObjects;
+  host.stopDsp();
+  auto& object = *objects.front();
+  float value  = 0;
+  auto const message = tr_offlinemeasure( kMessages, [&] { object.sendFloat( 1, value += 1 ); } );
+  std::printf( "%-20s %10.1f %12.1f\n", name, block, message );
+}
+
+//------------------------------------------------------------------------------
+int main() {
+  tr_setuplibrary();
+  OfflineHost::instance().setBlockSize( 64 );
+  std::printf( "%-20s %10s %12s\n", "", "ns/block", "ns/message" );
+  measure( "gain_virtual~" );
+  measure( "gain_static~" );
+  return OfflineHost::instance().errorCount() ? 1 : 0;
+}
@@ -0,0 +1,88 @@
+//
+//  bench_examples.cpp
+//  TRextern
+//
+//  Copyright © 2026 Reactify. All rights reserved.
+//
+
+// Cost of a DSP block and of a message for the bundled examples, measured
+// on the offline host at 64 samples per block. balance~ is then timed at
+// 64, 256 and 1024 samples per block, with its balance set by a float and
+// driven by a signal
+
+#include <cstdio>
+#include "TRextern.h"
+
+static const long kIterations = 200000;
+
+//------------------------------------------------------------------------------
+static void report( const char *object, const char *what, double ns ) {
+  std::printf( "%-10s %-14s %8.1f ns\n", object, what, ns );
+}
+
+//------------------------------------------------------------------------------
+int main() {
+  tr_setuplibrary();
+  auto& host = OfflineHost::instance();
+  host.setBlockSize( 64 );
+
+  {
+    OfflineObject counter( "counter", { tr_atomfloat( 0 ), tr_atomfloat( 1000 ) } );
+    OfflineObject balance( "balance~", { tr_atomfloat( 0.25 ) } );
+    if ( !counter.isValid() || !balance.isValid() ) {
+      std::fprintf( stderr, "bench_examples: could not create the examples\n" );
+      return 1;
+    }
+
+    host.startDsp();
+    for ( int i = 0; i < host.blockSize(); i++ ) {
+      balance.input( 0 )[i] = 1;
+      balance.input( 1 )[i] = -1;
+    }
+
+    // counter has no DSP, so a tick only runs balance~
+    report( "balance~", "tick()", tr_offlinemeasure( kIterations, [&] { host.tick(); } ) );
+    report( "balance~", "sendFloat()", tr_offlinemeasure( kIterations, [&] {
+      balance.sendFloat( 2, 0.5f );
+    } ) );
+    // Alternating values so every message starts a new ramp
+    float value = 0;
+    report( "balance~", "sendFloat()+tick()", tr_offlinemeasure( kIterations, [&] {
+      balance.sendFloat( 2, value = 1 - value );
+      host.tick();
+    } ) );
+
+    report( "counter", "sendFloat()", tr_offlinemeasure( kIterations, [&] {
+      counter.sendFloat( 1, 1.f );
+    } ) );
+    // Output is captured, so clear it now and then
+    long bangs = 0;
+    report( "counter", "sendBang()", tr_offlinemeasure( kIterations, [&] {
+      counter.sendBang( 0 );
+      if ( ++bangs % 1024 == 0 ) counter.clearMessages();
+    } ) );
+
+    host.stopDsp();
+  }
+
+  // Objects from above are gone, so each tick runs one balance~
+  std::printf( "\n%-10s %-8s %-8s %10s %10s\n", "object", "block", "balance", "ns/block", "ns/sample" );
+  for ( int block : { 64, 256, 1024 } ) {
+    host.setBlockSize( block );
+    for ( bool signal : { false, true } ) {
+      OfflineObject obj( "balance~", { tr_atomfloat( 0.25 ) } );
+      obj.setInputChannels( { 1, 1, signal ? 1 : 0 } );
+      host.startDsp();
+      for ( int i = 0; i < block; i++ ) {
+        obj.input( 0 )[i] = 1;
+        obj.input( 1 )[i] = -1;
+        if ( signal ) obj.input( 2 )[i] = float(i) / block;
+      }
+      auto const ns = tr_offlinemeasure( kIterations * 64 / block, [&] { host.tick(); } );
+      std::printf( "%-10s %-8d %-8s %10.1f %10.2f\n", "balance~", block, signal ? "signal" : "float",
+                   ns, ns / block );
+      host.stopDsp();
+    }
+  }
+  return host.errorCount() ? 1 : 0;
+}
@@ -0,0 +1,53 @@
+//
+//  bench_inlets.cpp
+//  TRextern
+//
+//  Copyright © 2026 Reactify. All rights reserved.
+//
+
+// Cost of many control inlets: creating and freeing an object with 8, 32
+// and 128 float inlets, and sending a float to its first and its last
+// inlet. Each inlet has a receiver of its own, generated for indices up
+// to TREXTERN_MAX_INLETS, so TRextern itself does the same work for any
+// inlet. Like Pd, the offline host finds the float method by searching
+// the receiver's methods, which later inlets pay a little for
+
+#include <cstdio>
+#include <string>
+#include "TRextern.h"
+
+static const long kObjects  = 2000;
+static const long kMessages = 1000000;
+
+//! As many float inlets as its first argument asks for
+class inlets_bench : public TRextern {
+public:
+  void  setup( int argc, t_atom *argv ) override {
+    auto const count = argc ? (int)atom_getfloat( argv ) : 1;
+    for ( int i = 0; i < count; i++ ) addInletFloat( "in" + std::to_string( i ) );
+  }
+  void  floatReceived( InletRef inlet, t_sample value ) override { mSum += inlet.getIndex() + value; }
+  double mSum = 0;
+};
+
+TREXTERN_CREATE(inlets_bench)
+
+//------------------------------------------------------------------------------
+int main() {
+  tr_setuplibrary();
+  std::printf( "%-8s %12s %12s %12s\n", "inlets", "create ns", "first ns", "last ns" );
+  for ( int inlets : { 8, 32, TREXTERN_MAX_INLETS } ) {
+    auto const create = tr_offlinemeasure( kObjects, [&] {
+      OfflineObject obj( "inlets_bench", { tr_atomfloat( inlets ) } );
+    } );
+    OfflineObject obj( "inlets_bench", { tr_atomfloat( inlets ) } );
+    if ( obj.inletCount() != inlets ) {
+      std::fprintf( stderr, "bench_inlets: %d inlets asked for, %d made\n", inlets, obj.inletCount() );
+      return 1;
+    }
+    auto const first = tr_offlinemeasure( kMessages, [&] { obj.sendFloat( 0, 1 ); } );
+    auto const last  = tr_offlinemeasure( kMessages, [&] { obj.sendFloat( inlets - 1, 1 ); } );
+    std::printf( "%-8d %12.1f %12.1f %12.1f\n", inlets, create, first, last );
+  }
+  return OfflineHost::instance().errorCount() ? 1 : 0;
+}
@@ -0,0 +1,70 @@
+//
+//  bench_kernels.cpp
+//  TRextern
+//
+//  Copyright © 2026 Reactify. All rights reserved.
+//
+
+// Each kernel as objects call it, through tr_gain() and the others,
+// against the scalar kernels, on float blocks of 64, 256 and 1024
+// samples. The scalar loops are built with the same flags, so the
+// compiler may vectorise some of them itself
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "TRextern.h"
+
+static const long kSamples = 1 << 24;
+static const long kTaps    = 16;
+
+using Scalar = KernelSet<ScalarOps<float>>;
+
+//------------------------------------------------------------------------------
+//! Time per call of fn( n ) in nanoseconds, over about kSamples samples
+template<class Fn>
+static double measure( long n, Fn&& fn ) {
+  return tr_offlinemeasure( kSamples / n, [&] { fn( n ); } );
+}
+
+template<class Test, class Reference>
+static void report( const char *kernel, long n, Test&& test, Reference&& reference ) {
+  auto const dispatched = measure( n, test );
+  auto const scalar     = measure( n, reference );
+  std::printf( "%-11s %6ld %11.1f %11.1f %8.2f\n", kernel, n, dispatched, scalar, scalar / dispatched );
+}
+
+//------------------------------------------------------------------------------
+int main() {
+  std::vector<float> a( 1024 + 2 * kTaps ), b( 1024 ), mix( 1024 ), out( 1024 ), coeffs( kTaps );
+  for ( size_t i = 0; i < a.size(); i++ ) a[i] = std::sin( 0.1f * i );
+  for ( size_t i = 0; i < b.size(); i++ ) b[i] = std::cos( 0.1f * i );
+  for ( size_t i = 0; i < mix.size(); i++ ) mix[i] = 0.5f + 0.5f * std::sin( 0.01f * i );
+  for ( size_t i = 0; i < coeffs.size(); i++ ) coeffs[i] = 1.f / (i + 1);
+  auto const pa = a.data(), pb = b.data(), pm = mix.data(), po = out.data(), pc = coeffs.data();
+
+  std::printf( "%-11s %6s %11s %11s %8s\n", "kernel", "n", "ns", "scalar ns", "speedup" );
+  for ( long n : { 64, 256, 1024 } ) {
+    report( "gain", n, [&]( long n ) { tr_gain( po, pa, 0.7f, n ); },
+                       [&]( long n ) { Scalar::gain( po, pa, 0.7f, n ); } );
+    report( "crossfade", n, [&]( long n ) { tr_crossfade( po, pa, pb, 0.3f, n ); },
+                            [&]( long n ) { Scalar::crossfade( po, pa, pb, 0.3f, n ); } );
+    report( "crossfadev", n, [&]( long n ) { tr_crossfade( po, pa, pb, pm, n ); },
+                             [&]( long n ) { Scalar::crossfadev( po, pa, pb, pm, n ); } );
+    report( "add", n, [&]( long n ) { tr_add( po, pa, pb, n ); },
+                      [&]( long n ) { Scalar::add( po, pa, pb, n ); } );
+    report( "multiply", n, [&]( long n ) { tr_multiply( po, pa, pb, n ); },
+                           [&]( long n ) { Scalar::multiply( po, pa, pb, n ); } );
+    report( "clamp", n, [&]( long n ) { tr_clamp( po, pa, -0.5f, 0.5f, n ); },
+                        [&]( long n ) { Scalar::clamp( po, pa, -0.5f, 0.5f, n ); } );
+    report( "ramp", n, [&]( long n ) { tr_ramp( po, 0.f, 0.001f, n ); },
+                       [&]( long n ) { Scalar::ramp( po, 0.f, 0.001f, n ); } );
+    report( "copy", n, [&]( long n ) { tr_copy( po, pa, n ); },
+                       [&]( long n ) { Scalar::copy( po, pa, n ); } );
+    report( "clear", n, [&]( long n ) { tr_clear( po, n ); },
+                        [&]( long n ) { Scalar::clear( po, n ); } );
+    report( "fir", n, [&]( long n ) { tr_fir( po, pa, pc, kTaps, n ); },
+                      [&]( long n ) { Scalar::fir( po, pa, pc, kTaps, n ); } );
+  }
+  return 0;
+}
@@ -0,0 +1,59 @@
+//
+//  bench_library.cpp
+//  TRextern
+//
+//  Copyright © 2026 Reactify. All rights reserved.
+//
+
+// Loads classes the way Pd does: dlopen a binary and call its setup
+// function. Run by bench_library.sh, which builds the binaries.
+//
+//   bench_library lib DIR N   loads DIR/objs.so and calls objs_setup
+//   bench_library sep DIR N   loads DIR/obj0.so to DIR/obj<N-1>.so
+//
+// Prints the time taken in milliseconds.
+
+#include <dlfcn.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+//------------------------------------------------------------------------------
+static bool load( std::string const& path, std::string const& setup ) {
+  auto handle = dlopen( path.c_str(), RTLD_NOW | RTLD_LOCAL );
+  if ( !handle ) {
+    std::fprintf( stderr, "bench_library: %s\n", dlerror() );
+    return false;
+  }
+  auto fn = (void (*)(void))dlsym( handle, setup.c_str() );
+  if ( !fn ) {
+    std::fprintf( stderr, "bench_library: no %s in %s\n", setup.c_str(), path.c_str() );
+    return false;
+  }
+  fn();
+  return true;
+}
+
+//------------------------------------------------------------------------------
+int main( int argc, char **argv ) {
+  if ( argc < 4 ) {
+    std::fprintf( stderr, "usage: bench_library lib|sep DIR N\n" );
+    return 1;
+  }
+  std::string const mode = argv[1];
+  std::string const dir  = argv[2];
+  auto const count = std::atoi( argv[3] );
+  auto const start = std::chrono::steady_clock::now();
+  if ( mode == "lib" ) {
+    if ( !load( dir + "/objs.so", "objs_setup" ) ) return 1;
+  } else {
+    for ( int i = 0; i < count; i++ ) {
+      auto const name = "obj" + std::to_string( i );
+      if ( !load( dir + "/" + name + ".so", name + "_setup" ) ) return 1;
+    }
+  }
+  auto const ms = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+  std::printf( "%.2f\n", ms );
+  return 0;
+}
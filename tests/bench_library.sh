@@ -0,0 +1,56 @@
+#!/bin/sh
+#
+#  bench_library.sh
+#  TRextern
+#
+#  Copyright © 2026 Reactify. All rights reserved.
+#
+
+# Load time of N classes built as one library with TREXTERN_LIBRARY,
+# against the same classes built as N separate binaries. The classes are
+# copies of the examples, renamed obj0 to obj<N-1>. Each build is loaded
+# RUNS times by bench_library, which prints milliseconds, and the sizes
+# on disk are listed after. Run it from tests/ or with `make library`:
+#
+#   sh bench_library.sh [N] [RUNS]
+
+set -e
+
+N=${1:-40}
+RUNS=${2:-5}
+CXX=${CXX:-c++}
+CXXFLAGS=${CXXFLAGS:-"-O3 -DNDEBUG"}
+FLAGS="-std=c++17 -DTREXTERN_OFFLINE -I.. -fPIC -fvisibility=hidden -fvisibility-inlines-hidden $CXXFLAGS"
+DIR=library_bench
+
+rm -rf $DIR
+mkdir -p $DIR/src $DIR/sep $DIR/lib
+
+echo "bench_library: building $N classes"
+i=0
+while [ $i -lt $N ]; do
+  if [ $((i % 2)) -eq 0 ]; then CLASS=balance_tilde; else CLASS=counter; fi
+  sed "s/\b$CLASS\b/obj$i/g" ../examples/$CLASS.cpp > $DIR/src/obj$i.cpp
+  $CXX $FLAGS -c $DIR/src/obj$i.cpp -o $DIR/src/obj$i.o
+  $CXX -shared $DIR/src/obj$i.o -o $DIR/sep/obj$i.so -lpthread
+  i=$((i + 1))
+done
+printf '#include "TRextern.h"\nTREXTERN_LIBRARY( objs )\n' > $DIR/src/objs.cpp
+$CXX $FLAGS -c $DIR/src/objs.cpp -o $DIR/src/objs.o
+$CXX -shared $DIR/src/obj*.o -o $DIR/lib/objs.so -lpthread
+$CXX -std=c++17 -O2 -o $DIR/bench_library bench_library.cpp -ldl
+
+printf '%-10s' "run"
+r=1
+while [ $r -le $RUNS ]; do printf '%8d' $r; r=$((r + 1)); done
+printf '   ms\n'
+for MODE in sep lib; do
+  printf '%-10s' $MODE
+  r=1
+  while [ $r -le $RUNS ]; do
+    printf '%8s' "$(./$DIR/bench_library $MODE $DIR/$MODE $N)"
+    r=$((r + 1))
+  done
+  printf '\n'
+done
+du -sk $DIR/sep $DIR/lib | awk '{ printf "%-10s %8d KiB\n", $2, $1 }'
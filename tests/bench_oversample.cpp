@@ -0,0 +1,50 @@
+//
+//  bench_oversample.cpp
+//  TRextern
+//
+//  Copyright © 2026 Reactify. All rights reserved.
+//
+
+// Cost of oversampling: an object with one signal inlet and outlet that
+// copies its input, run at 1x, 2x, 4x and 8x on 64 sample blocks. What
+// the higher factors add to 1x is the cost of the filters
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include "TRextern.h"
+
+static const long kBlocks = 200000;
+
+//! Copies its input at the rate given by the first argument
+class oversample_tilde : public TRextern {
+public:
+  void  setup( int argc, t_atom *argv ) override {
+    setupIO( 1, 1 );
+    if ( argc ) setOversampling( (int)atom_getfloat( argv ) );
+  }
+  void  process( t_sample **const ins, t_sample **const outs, long size ) override {
+    std::copy( ins[0], ins[0] + size, outs[0] );
+  }
+};
+
+TREXTERN_CREATE(oversample_tilde)
+
+//------------------------------------------------------------------------------
+int main() {
+  tr_setuplibrary();
+  auto& host = OfflineHost::instance();
+  host.setBlockSize( 64 );
+  std::printf( "%-8s %10s %10s\n", "factor", "us/block", "added" );
+  double base = 0;
+  for ( int factor : { 1, 2, 4, 8 } ) {
+    OfflineObject obj( "oversample~", { tr_atomfloat( factor ) } );
+    host.startDsp();
+    for ( int i = 0; i < host.blockSize(); i++ ) obj.input( 0 )[i] = std::sin( i * 0.1f );
+    auto const us = tr_offlinemeasure( kBlocks, [&] { host.tick(); } ) / 1000;
+    if ( factor == 1 ) base = us;
+    std::printf( "%-8d %10.2f %10.2f\n", factor, us, us - base );
+    host.stopDsp();
+  }
+  return host.errorCount() ? 1 : 0;
+}
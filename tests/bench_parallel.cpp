@@ -0,0 +1,82 @@
+//
+//  bench_parallel.cpp
+//  TRextern
+//
+//  Copyright © 2026 Reactify. All rights reserved.
+//
+
+// Scaling of parallel mode: 16 objects with an expensive process(), run
+// serially on the audio thread, then in parallel with the audio thread
+// and 1 or 3 DSP threads. Thread counts the machine has no cores for are
+// skipped
+
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "TRextern.h"
+
+static const int  kObjects = 16;
+static const long kBlocks  = 200;
+
+//! Some hundred sines per sample, with the first argument turning on
+//  parallel mode
+class heavy_tilde : public TRextern {
+public:
+  void  setup( int argc, t_atom *argv ) override {
+    setupIO( 1, 1 );
+    setParallel( argc && atom_getfloat( argv ) != 0 );
+  }
+  void  process( t_sample **const ins, t_sample **const outs, long size ) override {
+    for ( long i = 0; i < size; i++ ) {
+      t_sample x = ins[0][i];
+      for ( int k = 0; k < 100; k++ ) x = std::sin( x ) * 0.999f + 0.001f;
+      outs[0][i] = x;
+    }
+  }
+};
+
+TREXTERN_CREATE(heavy_tilde)
+
+//------------------------------------------------------------------------------
+static double measure( bool parallel ) {
+  auto& host = OfflineHost::instance();
+  std::vector<std::unique_ptr<OfflineObject>> objects;
+  for ( int i = 0; i < kObjects; i++ ) {
+    objects.emplace_back( new OfflineObject( "heavy~", { tr_atomfloat( parallel ) } ) );
+  }
+  host.startDsp();
+  host.tick( 10 );
+  auto const ns = tr_offlinemeasure( kBlocks, [&] { host.tick(); } );
+  host.stopDsp();
+  return ns;
+}
+
+//------------------------------------------------------------------------------
+int main() {
+  tr_setuplibrary();
+  OfflineHost::instance().setBlockSize( 64 );
+  auto const cores = (int)std::thread::hardware_concurrency();
+  if ( cores < 2 ) {
+    std::printf( "bench_parallel: skipped, parallel mode needs more than one core\n" );
+    return 0;
+  }
+  std::printf( "%-8s %10s %8s\n", "threads", "us/block", "speedup" );
+  auto const serial = measure( false );
+  std::printf( "%-8d %10.1f %8.2f\n", 1, serial / 1000, 1.0 );
+  for ( int threads : { 2, 4 } ) {
+    if ( threads > cores ) {
+      std::printf( "%-8d skipped, %d cores\n", threads, cores );
+      continue;
+    }
+    // The first parallel object to prepare starts the pool if there is
+    // none, so replace it while no parallel objects exist. The audio
+    // thread makes one more
+    delete m_dsppool;
+    m_dsppool = new DspPool( threads - 1 );
+    auto const ns = measure( true );
+    std::printf( "%-8d %10.1f %8.2f\n", threads, ns / 1000, serial / ns );
+  }
+  return OfflineHost::instance().errorCount() ? 1 : 0;
+}
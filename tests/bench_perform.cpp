@@ -0,0 +1,115 @@
+//
+//  bench_perform.cpp
+//  TRextern
+//
+//  Copyright © 2026 Reactify. All rights reserved.
+//
+
+// Cost of the perform routine per object and block: many instances of an
+// object whose process() does nothing, so what is measured is the work
+// around it, with the offline host's own share included. For comparison,
+// the same objects are then run by the perform routine TRextern had
+// before the channel tables, which walks the DSP vector for the signal
+// pointers into arrays made with alloca() on every block. The current
+// routine also renders parameters and flushes messages, so a third one
+// calls process() with the channel tables and nothing else
+
+#include <alloca.h>
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include "TRextern.h"
+
+static const int  kObjects = 256;
+static const long kBlocks  = 2000;
+
+class empty_tilde : public TRextern {
+public:
+  void  setup( int argc, t_atom *argv ) override {
+    auto const channels = argc ? (int)atom_getfloat( argv ) : 1;
+    setupIO( channels, channels );
+  }
+  void  process( t_sample **const /*ins*/, t_sample **const /*outs*/, long /*size*/ ) override {}
+};
+
+TREXTERN_CREATE(empty_tilde)
+
+//------------------------------------------------------------------------------
+//! The old perform routine. The DSP vector holds the object, its inputs
+//  and outputs, then the block size
+static t_int *legacy_perform( t_int *w ) {
+  size_t vIndex = 1;
+
+  auto impl = ((t_external *)w[vIndex++])->impl;
+
+  auto const numIn  = impl->inChannelCount();
+  auto const numOut = impl->outChannelCount();
+
+  t_sample **const bIn = (t_sample **)alloca(numIn * sizeof(t_sample *));
+  for ( auto i = 0; i < numIn; i++ ) {
+    bIn[i] = (t_sample *)w[vIndex++];
+  }
+
+  t_sample **const bOut = (t_sample **)alloca(numOut * sizeof(t_sample *));
+  for ( auto i = 0; i < numOut; i++ ) {
+    bOut[i] = (t_sample *)w[vIndex++];
+  }
+
+  impl->process( bIn, bOut, (long)w[vIndex++] /*n*/ );
+
+  return (w+vIndex);
+}
+
+//! Only the channel tables, as the current routine gets them. The DSP
+//  vector holds the object and the block size
+static t_int *table_perform( t_int *w ) {
+  auto x = (t_external *)w[1];
+  x->impl->process( x->channels.ins, x->channels.outs, (long)w[2] );
+  return (w+3);
+}
+
+//! Replaces the DSP chain by one calling legacy_perform or table_perform
+//  for every object
+static void usePerform( t_perfroutine perform, std::vector<std::unique_ptr<OfflineObject>> const& objects,
+                        int channels ) {
+  auto& host = OfflineHost::instance();
+  host.chain.clear();
+  for ( auto& obj : objects ) {
+    std::vector<t_int> routine = { (t_int)perform, (t_int)obj->object() };
+    if ( perform == legacy_perform ) {
+      for ( int c = 0; c < channels; c++ ) routine.push_back( (t_int)obj->input( c ) );
+      for ( int c = 0; c < channels; c++ ) routine.push_back( (t_int)obj->output( c ) );
+    }
+    routine.push_back( (t_int)host.blockSize() );
+    host.chain.push_back( routine );
+  }
+}
+
+//------------------------------------------------------------------------------
+int main() {
+  tr_setuplibrary();
+  auto& host = OfflineHost::instance();
+  std::printf( "%-10s %-10s %10s %10s %10s\n", "channels", "block", "current", "tables", "alloca" );
+  for ( int channels : { 1, 2, 8 } ) {
+    for ( int block : { 64, 256 } ) {
+      host.setBlockSize( block );
+      std::vector<std::unique_ptr<OfflineObject>> objects;
+      for ( int i = 0; i < kObjects; i++ ) {
+        objects.emplace_back( new OfflineObject( "empty~", { tr_atomfloat( channels ) } ) );
+      }
+      host.startDsp();
+      host.tick( 10 );
+      auto const ns = tr_offlinemeasure( kBlocks, [&] { host.tick(); } );
+      usePerform( table_perform, objects, channels );
+      host.tick( 10 );
+      auto const tables = tr_offlinemeasure( kBlocks, [&] { host.tick(); } );
+      usePerform( legacy_perform, objects, channels );
+      host.tick( 10 );
+      auto const legacy = tr_offlinemeasure( kBlocks, [&] { host.tick(); } );
+      std::printf( "%-10d %-10d %10.1f %10.1f %10.1f\n", channels, block,
+                   ns / kObjects, tables / kObjects, legacy / kObjects );
+      host.stopDsp();
+    }
+  }
+  return host.errorCount() ? 1 : 0;
+}
@@ -0,0 +1,120 @@
+//
+//  bench_poly.cpp
+//  TRextern
+//
+//  Copyright © 2026 Reactify. All rights reserved.
+//
+
+// A polyphonic oscillator on VoicePool with 64 and 256 voices, timed per
+// block with a quarter and with all of the voices sounding, then with
+// every voice held and 8 notes stealing voices each block
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include "TRextern.h"
+#include "TRpoly.h"
+
+static const long kBlocks = 5000;
+
+//! Parabolic sine, phase in [0, 1)
+static inline float parabola( float phase ) {
+  auto const x = 2 * phase - 1;
+  return 4 * x * (1 - std::fabs( x ));
+}
+
+class poly_tilde : public TRextern {
+public:
+  void  setup( int argc, t_atom *argv ) override {
+    setupIO( 1, 1 );
+    addInletList( "notes" );
+    mVoices.reset( new VoicePool( argc ? (size_t)atom_getfloat( argv ) : 16 ) );
+    mPhase  = mVoices->addColumn<float>();
+    mStep   = mVoices->addColumn<float>();
+    mEnv    = mVoices->addColumn<float>();
+  }
+
+  void  listReceived( InletRef, AtomSpan atoms ) override { mVoices->receive( atoms ); }
+
+  void  process( t_sample **const, t_sample **const outs, long size ) override {
+    mVoices->beginBlock();
+    for ( auto v : mVoices->started() ) {
+      mPhase[v] = 0;
+      mStep[v]  = 440.f * std::exp2( (mVoices->pitch()[v] - 69) / 12.f ) / 44100.f;
+    }
+    auto const phase  = mPhase.data();
+    auto const step   = mStep.data();
+    auto const env    = mEnv.data();
+    auto const gate   = mVoices->gate();
+    auto const active = mVoices->active();
+    for ( long i = 0; i < size; i++ ) {
+      t_sample sum = 0;
+      for ( size_t v = 0; v < active; v++ ) {
+        auto p = phase[v] + step[v];
+        p -= (int)p;
+        phase[v] = p;
+        env[v] += (gate[v] - env[v]) * 0.001f;
+        sum += parabola( p ) * env[v];
+      }
+      outs[0][i] = sum;
+    }
+    for ( auto v : mVoices->released() ) mVoices->finish( v );
+    mVoices->endBlock();
+  }
+
+  std::unique_ptr<VoicePool> mVoices;
+  VoiceColumn<float>         mPhase;
+  VoiceColumn<float>         mStep;
+  VoiceColumn<float>         mEnv;
+};
+
+TREXTERN_CREATE(poly_tilde)
+
+//------------------------------------------------------------------------------
+static std::vector<t_atom> notes( int first, int count, float velocity ) {
+  std::vector<t_atom> atoms;
+  for ( int n = 0; n < count; n++ ) {
+    atoms.push_back( tr_atomfloat( first + n % 96 ) );
+    atoms.push_back( tr_atomfloat( velocity ) );
+  }
+  return atoms;
+}
+
+//------------------------------------------------------------------------------
+int main() {
+  tr_setuplibrary();
+  auto& host = OfflineHost::instance();
+  host.setBlockSize( 64 );
+  std::printf( "%-8s %-8s %12s\n", "voices", "active", "ns/block" );
+  for ( int voices : { 64, 256 } ) {
+    for ( int active : { voices / 4, voices } ) {
+      OfflineObject obj( "poly~", { tr_atomfloat( voices ) } );
+      host.startDsp();
+      // In batches of 128 notes, as the pool queues 256 events per block
+      for ( int n = 0; n < active; n += 128 ) {
+        obj.sendList( 1, notes( 12 + n, std::min( 128, active - n ), 1 ) );
+        host.tick();
+      }
+      auto const ns = tr_offlinemeasure( kBlocks, [&] { host.tick(); } );
+      std::printf( "%-8d %-8d %12.1f\n", voices, active, ns );
+      host.stopDsp();
+    }
+    OfflineObject obj( "poly~", { tr_atomfloat( voices ) } );
+    host.startDsp();
+    for ( int n = 0; n < voices; n += 128 ) {
+      obj.sendList( 1, notes( 12 + n, std::min( 128, voices - n ), 1 ) );
+      host.tick();
+    }
+    int next = 0;
+    auto const ns = tr_offlinemeasure( kBlocks, [&] {
+      obj.sendList( 1, notes( 12 + next, 8, 1 ) );
+      next = (next + 8) % 96;
+      host.tick();
+    } );
+    std::printf( "%-8d %-8s %12.1f\n", voices, "+8 stolen", ns );
+    host.stopDsp();
+  }
+  return host.errorCount() ? 1 : 0;
+}
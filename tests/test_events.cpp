@@ -0,0 +1,102 @@
+//
+//  test_events.cpp
+//  TRextern
+//
+//  Copyright © 2026 Reactify. All rights reserved.
+//
+
+// Times of messages scheduled from process(). The object runs frames of
+// the size of its first argument, oversampled by its second, and sends
+// how many samples it had processed before a message, at an offset of 8
+// into every process() call. Pd must deliver each message at the logical
+// time its sample comes out of the object, latency() included, whatever
+// the frame size and the oversampling factor
+
+#include <cmath>
+#include <cstdio>
+#include "TRextern.h"
+
+static const long kOffset = 8;
+
+class events_test : public TRextern {
+public:
+  void  setup( int argc, t_atom *argv ) override {
+    setupIO( 1, 1 );
+    mOut = addOutlet( "samples" );
+    if ( argc > 0 ) setProcessBlockSize( (long)atom_getfloat( argv ) );
+    if ( argc > 1 ) setOversampling( (int)atom_getfloat( argv + 1 ) );
+  }
+  void  process( t_sample **const ins, t_sample **const outs, long size ) override {
+    std::copy( ins[0], ins[0] + size, outs[0] );
+    scheduleFloat( mOut, t_sample(mSamples + kOffset), kOffset );
+    mSamples += size;
+  }
+  OutletRef mOut;
+  long      mSamples = 0;
+};
+
+TREXTERN_CREATE(events_test)
+
+static int gFailures = 0;
+
+#define CHECK( condition ) do { \
+  if ( !(condition) ) { \
+    std::fprintf( stderr, "%s:%d: %s failed\n", __FILE__, __LINE__, #condition ); \
+    gFailures++; \
+  } \
+} while ( 0 )
+
+//------------------------------------------------------------------------------
+//! Runs the object and checks the time of every message it sent against
+//  that of its sample plus the expected latency, in host samples
+static void check( long frame, int factor, long latency ) {
+  auto& host = OfflineHost::instance();
+  OfflineObject obj( "events_test", { tr_atomfloat( frame ), tr_atomfloat( factor ) } );
+  CHECK( obj.isValid() );
+  host.startDsp();
+  // Blocks run at the logical time their last sample is due, so the first
+  // sample of the first block is one block earlier
+  auto const start = host.time();
+  host.tick( 40 );
+  host.stopDsp();
+  auto const& messages = obj.messages( 1 );
+  CHECK( !messages.empty() );
+  for ( auto const& m : messages ) {
+    // Sample of the message at the host's rate
+    auto const sample = (long)atom_getfloat( m.atoms.data() ) / factor + latency;
+    auto const expected = start + 1000.0 * (host.blockSize() + sample) / host.sampleRate();
+    if ( std::fabs( m.time - expected ) > 1e-6 ) {
+      std::fprintf( stderr, "frame %ld, %dx: sample %ld sent at %f ms, expected %f ms\n",
+                    frame, factor, sample, m.time, expected );
+      gFailures++;
+      return;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+int main() {
+  tr_setuplibrary();
+  auto& host = OfflineHost::instance();
+  host.setBlockSize( 64 );
+
+  check( 0,   1, 0 );
+  // Frames dividing the block, in place
+  check( 32,  1, 0 );
+  // Frames of 96 and 256 samples are 64 and 192 samples late
+  check( 96,  1, 64 );
+  check( 256, 1, 192 );
+  // The oversampler's filters delay by 31, 39 and 43 samples
+  check( 0,   2, 31 );
+  check( 0,   4, 39 );
+  check( 0,   8, 43 );
+  check( 96,  4, 64 + 39 );
+  CHECK( host.errorCount() == 0 );
+
+  if ( gFailures ) {
+    std::fprintf( stderr, "test_events: %d checks failed\n", gFailures );
+    return 1;
+  }
+  std::printf( "test_events: passed\n" );
+  return 0;
+}
@@ -0,0 +1,116 @@
+//
+//  test_inlets.cpp
+//  TRextern
+//
+//  Copyright © 2026 Reactify. All rights reserved.
+//
+
+// An object with as many inlets as its first argument asks for, taking
+// turns at bang, float, symbol and list, starting at the type given by the
+// second argument. Each message must reach the callback of its type with
+// the index of the inlet it was sent to, up to TREXTERN_MAX_INLETS inlets
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "TRextern.h"
+
+//! Last callback made by any inlets_test object
+struct Received {
+  IOType   type;
+  size_t   inlet;
+  t_sample value;
+  std::string symbol;
+};
+static Received gReceived;
+
+class inlets_test : public TRextern {
+public:
+  void  setup( int argc, t_atom *argv ) override {
+    auto const count = argc > 0 ? (int)atom_getfloat( argv ) : 0;
+    auto const first = argc > 1 ? (int)atom_getfloat( argv + 1 ) : 0;
+    for ( int i = 0; i < count; i++ ) {
+      auto const id = "in" + std::to_string( i );
+      switch ( (first + i) % 4 ) {
+        case 0: addInletBang( id );   break;
+        case 1: addInletFloat( id );  break;
+        case 2: addInletSymbol( id ); break;
+        case 3: addInletList( id );   break;
+      }
+    }
+  }
+
+  void  bangReceived( InletRef inlet ) override {
+    gReceived = { IOType::Bang, inlet.getIndex(), 0, "" };
+  }
+  void  floatReceived( InletRef inlet, t_sample value ) override {
+    gReceived = { IOType::Float, inlet.getIndex(), value, "" };
+  }
+  void  symbolReceived( InletRef inlet, t_symbol *symbol ) override {
+    gReceived = { IOType::Symbol, inlet.getIndex(), 0, symbol->s_name };
+  }
+  void  listReceived( InletRef inlet, AtomSpan atoms ) override {
+    gReceived = { IOType::List, inlet.getIndex(), atoms.getFloat( 1 ), "" };
+  }
+};
+
+TREXTERN_CREATE(inlets_test)
+
+static const IOType kTypes[] = { IOType::Bang, IOType::Float, IOType::Symbol, IOType::List };
+
+static int gFailures = 0;
+
+#define CHECK( condition ) do { \
+  if ( !(condition) ) { \
+    std::fprintf( stderr, "%s:%d: %s failed\n", __FILE__, __LINE__, #condition ); \
+    gFailures++; \
+  } \
+} while ( 0 )
+
+//------------------------------------------------------------------------------
+int main() {
+  tr_setuplibrary();
+  auto& host = OfflineHost::instance();
+
+  {
+    OfflineObject obj( "inlets_test", { tr_atomfloat( TREXTERN_MAX_INLETS ) } );
+    CHECK( obj.isValid() );
+    CHECK( obj.inletCount() == TREXTERN_MAX_INLETS );
+    CHECK( host.errorCount() == 0 );
+    for ( int i = 0; i < obj.inletCount(); i++ ) {
+      auto const value = t_sample(i) + 0.5f;
+      gReceived = { IOType::Anything, size_t(-1), 0, "" };
+      switch ( i % 4 ) {
+        case 0: obj.sendBang( i ); break;
+        case 1: obj.sendFloat( i, value ); break;
+        case 2: obj.sendSymbol( i, ("s" + std::to_string( i )).c_str() ); break;
+        case 3: obj.sendList( i, { tr_atomfloat( 0 ), tr_atomfloat( value ) } ); break;
+      }
+      CHECK( gReceived.type == kTypes[i % 4] );
+      CHECK( gReceived.inlet == size_t(i) );
+      if ( i % 4 == 1 || i % 4 == 3 ) CHECK( gReceived.value == value );
+      if ( i % 4 == 2 ) CHECK( gReceived.symbol == "s" + std::to_string( i ) );
+    }
+    CHECK( host.errorCount() == 0 );
+  }
+
+  {
+    // A bang, float or symbol inlet past the limit is refused with an
+    // error. The object is still created, without that inlet
+    for ( int type = 0; type < 3; type++ ) {
+      auto const errors = host.errorCount();
+      auto const first  = (type - TREXTERN_MAX_INLETS % 4 + 4) % 4;
+      OfflineObject obj( "inlets_test", { tr_atomfloat( TREXTERN_MAX_INLETS + 1 ), tr_atomfloat( first ) } );
+      CHECK( obj.isValid() );
+      CHECK( host.errorCount() == errors + 1 );
+      CHECK( obj.inletCount() == TREXTERN_MAX_INLETS );
+    }
+  }
+
+  if ( gFailures ) {
+    std::fprintf( stderr, "test_inlets: %d checks failed\n", gFailures );
+    return 1;
+  }
+  std::printf( "test_inlets: passed\n" );
+  return 0;
+}
@@ -0,0 +1,151 @@
+//
+//  test_kernels.cpp
+//  TRextern
+//
+//  Copyright © 2026 Reactify. All rights reserved.
+//
+
+// Every kernel of every instruction set this machine can run, for float
+// and double, against the scalar kernels. Lengths cover empty blocks,
+// blocks shorter than a vector and odd tails, and every buffer starts at
+// an offset of 0 to 3 samples to test unaligned access. Samples past the
+// end of the output must be left alone
+
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <vector>
+#include "TRextern.h"
+
+static const long kLengths[] = { 0, 1, 2, 3, 5, 7, 8, 9, 15, 16, 17, 31, 63, 64, 65, 100, 255, 1023 };
+static const long kGuard     = 16;
+static const long kTaps      = 8;
+
+static int gFailures = 0;
+
+//------------------------------------------------------------------------------
+//! A buffer with room for any offset and length tested, filled with
+//  values in [-2, 2] that depend on seed
+template<class T>
+static std::vector<T> makeSignal( int seed ) {
+  std::vector<T> v( 2 * kTaps + 1023 + 4 + kGuard );
+  for ( size_t i = 0; i < v.size(); i++ ) v[i] = T( 2 * std::sin( 0.37 * i + seed ) );
+  return v;
+}
+
+//! Runs test( out, n ) with the kernels under test and scalar( out, n )
+//  with the scalar ones, and compares the outputs. Each output is filled with a marker
+//  first, which must survive past n
+template<class T>
+static void compare( const char *set, const char *kernel, long n, int offset,
+                     std::function<void( T *, long )> test, std::function<void( T *, long )> scalar ) {
+  T const marker = T(12345);
+  std::vector<T> got( n + 4 + kGuard, marker ), want( n + 4 + kGuard, marker );
+  test( got.data() + offset, n );
+  scalar( want.data() + offset, n );
+  // Vector and scalar code may round sums differently
+  T const tolerance = sizeof(T) == 4 ? T(1e-5) : T(1e-12);
+  for ( size_t i = 0; i < got.size(); i++ ) {
+    auto const ok = std::fabs( got[i] - want[i] ) <= tolerance * (1 + std::fabs( want[i] ));
+    if ( !ok ) {
+      std::fprintf( stderr, "%s<%s>::%s, %ld samples at offset %d: sample %ld is %g, expected %g\n",
+                    set, sizeof(T) == 4 ? "float" : "double", kernel, n, offset,
+                    long(i) - offset, double(got[i]), double(want[i]) );
+      gFailures++;
+      return;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+template<class K, class T>
+static void check( const char *set ) {
+  using S = KernelSet<ScalarOps<T>>;
+  auto const a   = makeSignal<T>( 1 );
+  auto const b   = makeSignal<T>( 2 );
+  auto const mix = makeSignal<T>( 3 );
+  auto const coeffs = makeSignal<T>( 4 );
+  for ( long n : kLengths ) {
+    for ( int o = 0; o < 4; o++ ) {
+      auto const pa = a.data() + o, pb = b.data() + o, pm = mix.data() + o;
+      compare<T>( set, "gain", n, o,
+        [&]( T *out, long n ) { K::gain( out, pa, T(0.7), n ); },
+        [&]( T *out, long n ) { S::gain( out, pa, T(0.7), n ); } );
+      compare<T>( set, "crossfade", n, o,
+        [&]( T *out, long n ) { K::crossfade( out, pa, pb, T(0.3), n ); },
+        [&]( T *out, long n ) { S::crossfade( out, pa, pb, T(0.3), n ); } );
+      compare<T>( set, "crossfadev", n, o,
+        [&]( T *out, long n ) { K::crossfadev( out, pa, pb, pm, n ); },
+        [&]( T *out, long n ) { S::crossfadev( out, pa, pb, pm, n ); } );
+      compare<T>( set, "add", n, o,
+        [&]( T *out, long n ) { K::add( out, pa, pb, n ); },
+        [&]( T *out, long n ) { S::add( out, pa, pb, n ); } );
+      compare<T>( set, "multiply", n, o,
+        [&]( T *out, long n ) { K::multiply( out, pa, pb, n ); },
+        [&]( T *out, long n ) { S::multiply( out, pa, pb, n ); } );
+      compare<T>( set, "clamp", n, o,
+        [&]( T *out, long n ) { K::clamp( out, pa, T(-1), T(1), n ); },
+        [&]( T *out, long n ) { S::clamp( out, pa, T(-1), T(1), n ); } );
+      compare<T>( set, "ramp", n, o,
+        [&]( T *out, long n ) { K::ramp( out, T(0.25), T(0.01), n ); },
+        [&]( T *out, long n ) { S::ramp( out, T(0.25), T(0.01), n ); } );
+      compare<T>( set, "copy", n, o,
+        [&]( T *out, long n ) { K::copy( out, pa, n ); },
+        [&]( T *out, long n ) { S::copy( out, pa, n ); } );
+      compare<T>( set, "clear", n, o,
+        [&]( T *out, long n ) { K::clear( out, n ); },
+        [&]( T *out, long n ) { S::clear( out, n ); } );
+      compare<T>( set, "fir", n, o,
+        [&]( T *out, long n ) { K::fir( out, pa, coeffs.data(), kTaps, n ); },
+        [&]( T *out, long n ) { S::fir( out, pa, coeffs.data(), kTaps, n ); } );
+      // In place, as process() often runs
+      compare<T>( set, "gain in place", n, o,
+        [&]( T *out, long n ) { std::copy( pa, pa + n, out ); K::gain( out, out, T(0.7), n ); },
+        [&]( T *out, long n ) { S::gain( out, pa, T(0.7), n ); } );
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+//! The entry points objects call, through the runtime switch if any
+template<class T>
+struct Dispatched {
+  static void gain( T *out, const T *in, T g, long n )                      { tr_gain( out, in, g, n ); }
+  static void crossfade( T *out, const T *a, const T *b, T m, long n )      { tr_crossfade( out, a, b, m, n ); }
+  static void crossfadev( T *out, const T *a, const T *b, const T *m, long n ) { tr_crossfade( out, a, b, m, n ); }
+  static void add( T *out, const T *a, const T *b, long n )                 { tr_add( out, a, b, n ); }
+  static void multiply( T *out, const T *a, const T *b, long n )            { tr_multiply( out, a, b, n ); }
+  static void clamp( T *out, const T *in, T lo, T hi, long n )              { tr_clamp( out, in, lo, hi, n ); }
+  static void ramp( T *out, T start, T step, long n )                       { tr_ramp( out, start, step, n ); }
+  static void copy( T *out, const T *in, long n )                           { tr_copy( out, in, n ); }
+  static void clear( T *out, long n )                                       { tr_clear( out, n ); }
+  static void fir( T *out, const T *in, const T *c, long taps, long n )     { tr_fir( out, in, c, taps, n ); }
+};
+
+//------------------------------------------------------------------------------
+template<class T>
+static void checkAll() {
+#if TR_KERNELS_X86
+  check<KernelSet<SseOps<T>>, T>( "SSE2" );
+  if ( __builtin_cpu_supports( "avx2" ) ) {
+    check<KernelSetAvx2<Avx2Ops<T>>, T>( "AVX2" );
+  } else {
+    std::printf( "test_kernels: AVX2 skipped, not supported by this CPU\n" );
+  }
+#elif TR_KERNELS_NEON
+  check<KernelSet<NeonOps<T>>, T>( "NEON" );
+#endif
+  check<Dispatched<T>, T>( "tr_" );
+}
+
+//------------------------------------------------------------------------------
+int main() {
+  checkAll<float>();
+  checkAll<double>();
+  if ( gFailures ) {
+    std::fprintf( stderr, "test_kernels: %d checks failed\n", gFailures );
+    return 1;
+  }
+  std::printf( "test_kernels: passed\n" );
+  return 0;
+}
@@ -0,0 +1,94 @@
+//
+//  test_oversample.cpp
+//  TRextern
+//
+//  Copyright © 2026 Reactify. All rights reserved.
+//
+
+// An impulse through an oversampled object that copies its input. The
+// filters are linear phase, so the response must peak and be centred at
+// the delay the object reports in latency(): 31, 39 and 43 samples at 2x,
+// 4x and 8x. The response must also sum to a gain of 1
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "TRextern.h"
+
+static const long kBlocks = 4;
+
+//! Last oversample_test object set up
+static TRextern *gObject = nullptr;
+
+class oversample_test : public TRextern {
+public:
+  void  setup( int argc, t_atom *argv ) override {
+    setupIO( 1, 1 );
+    if ( argc ) setOversampling( (int)atom_getfloat( argv ) );
+    gObject = this;
+  }
+  void  process( t_sample **const ins, t_sample **const outs, long size ) override {
+    std::copy( ins[0], ins[0] + size, outs[0] );
+  }
+};
+
+TREXTERN_CREATE(oversample_test)
+
+static int gFailures = 0;
+
+#define CHECK( condition ) do { \
+  if ( !(condition) ) { \
+    std::fprintf( stderr, "%s:%d: %s failed\n", __FILE__, __LINE__, #condition ); \
+    gFailures++; \
+  } \
+} while ( 0 )
+
+//------------------------------------------------------------------------------
+int main() {
+  tr_setuplibrary();
+  auto& host = OfflineHost::instance();
+  host.setBlockSize( 64 );
+
+  struct Case { int factor; long latency; };
+  for ( auto const& c : { Case{ 2, 31 }, Case{ 4, 39 }, Case{ 8, 43 } } ) {
+    OfflineObject obj( "oversample_test", { tr_atomfloat( c.factor ) } );
+    CHECK( obj.isValid() );
+    host.startDsp();
+    CHECK( gObject->latency() == c.latency );
+
+    // Response to an impulse at sample 0
+    std::vector<double> response;
+    for ( long b = 0; b < kBlocks; b++ ) {
+      std::fill( obj.input( 0 ), obj.input( 0 ) + host.blockSize(), t_sample(0) );
+      if ( b == 0 ) obj.input( 0 )[0] = 1;
+      host.tick();
+      response.insert( response.end(), obj.output( 0 ), obj.output( 0 ) + host.blockSize() );
+    }
+    host.stopDsp();
+
+    long peak = 0;
+    double sum = 0, energy = 0, centre = 0;
+    for ( size_t i = 0; i < response.size(); i++ ) {
+      if ( std::fabs( response[i] ) > std::fabs( response[peak] ) ) peak = (long)i;
+      sum    += response[i];
+      energy += response[i] * response[i];
+      centre += i * response[i] * response[i];
+    }
+    centre /= energy;
+    if ( peak != gObject->latency() || std::fabs( centre - gObject->latency() ) > 1e-3 ) {
+      std::fprintf( stderr, "%dx: latency() %ld, response peaks at %ld, centred at %.4f\n",
+                    c.factor, gObject->latency(), peak, centre );
+      gFailures++;
+    }
+    CHECK( std::fabs( sum - 1 ) < 1e-3 );
+  }
+  CHECK( host.errorCount() == 0 );
+
+  if ( gFailures ) {
+    std::fprintf( stderr, "test_oversample: %d checks failed\n", gFailures );
+    return 1;
+  }
+  std::printf( "test_oversample: passed\n" );
+  return 0;
+}